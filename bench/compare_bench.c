@@ -0,0 +1,223 @@
+// Benchmark for the positional digit compare
+// Times the old two loops (formatGuess() then a scan for a matching digit)
+// against each compare kernel in digit_compare.c, on text and on packed
+// digits, from game lengths up to ten million digits, after checking every
+// kernel against the old loops; then times the digit histogram kernels that
+// bulls-and-cows scoring uses
+// Build with "make bench" and run .\bench\compare_bench.exe [seed]
+
+#include "../digit_buffer.h"
+#include "../digit_compare.h"
+#include "../prng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TOTAL_DIGITS 400000000LL
+
+// Function to get the elapsed seconds since start
+static double secondsSince(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+// Function to do what submitGuess() used to: format the guess, then look for any matching digit
+static size_t oldCompare(const char *magicNumber, const char *guessed, char *formatted, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        if (guessed[i] == magicNumber[i])
+        {
+            formatted[i] = guessed[i];
+        }
+        else
+        {
+            formatted[i] = '-';
+        }
+    }
+    formatted[length] = '\0';
+    for (size_t i = 0; i < length; i++)
+    {
+        if (guessed[i] == magicNumber[i])
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Function to time one compare over the given length; returns nanoseconds per call
+static double timeCompare(DigitCompareKernel kernel, const char *magicNumber, const char *guessed, char *formatted, size_t length, size_t *checksum)
+{
+    long long rounds = TOTAL_DIGITS / (long long)length;
+    clock_t start = clock();
+    for (long long r = 0; r < rounds; r++)
+    {
+        if (kernel == DIGIT_COMPARE_AUTO)
+        {
+            *checksum += oldCompare(magicNumber, guessed, formatted, length);
+        }
+        else
+        {
+            *checksum += compareDigits(magicNumber, guessed, formatted, length).matches;
+        }
+    }
+    return secondsSince(start) * 1e9 / rounds;
+}
+
+// Function to time one packed compare over the given length; returns nanoseconds per call
+static double timePackedCompare(const DigitBuffer *magicNumber, const DigitBuffer *guessed, DigitBuffer *formatted, size_t length, size_t *checksum)
+{
+    long long rounds = TOTAL_DIGITS / (long long)length;
+    clock_t start = clock();
+    for (long long r = 0; r < rounds; r++)
+    {
+        *checksum += compareDigitWords(magicNumber->words, guessed->words, formatted->words, length).matches;
+    }
+    return secondsSince(start) * 1e9 / rounds;
+}
+
+// Function to check and time every kernel on one length
+static void benchLength(DigitRng *rng, size_t length)
+{
+    char *magicNumber = (char *)malloc(length + 1);
+    char *guessed = (char *)malloc(length + 1);
+    char *expected = (char *)malloc(length + 1);
+    char *formatted = (char *)malloc(length + 1);
+    DigitBuffer packedMagic = {NULL, 0};
+    DigitBuffer packedGuess = {NULL, 0};
+    DigitBuffer packedFormatted = {NULL, 0};
+    bool packed = reserveDigitBuffer(&packedMagic, (int)length) && reserveDigitBuffer(&packedGuess, (int)length) && reserveDigitBuffer(&packedFormatted, (int)length);
+    if (magicNumber == NULL || guessed == NULL || expected == NULL || formatted == NULL || !packed)
+    {
+        printf("Out of memory for length %zu\n", length);
+        free(magicNumber);
+        free(guessed);
+        free(expected);
+        free(formatted);
+        freeDigitBuffer(&packedMagic);
+        freeDigitBuffer(&packedGuess);
+        freeDigitBuffer(&packedFormatted);
+        return;
+    }
+
+    // A guess shares about one digit in ten with the magic number, like a real one
+    randomDigits(rng, magicNumber, (int)length);
+    randomDigits(rng, guessed, (int)length);
+    size_t expectedMatches = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        expectedMatches += guessed[i] == magicNumber[i];
+    }
+    oldCompare(magicNumber, guessed, expected, length);
+    packDigits(&packedMagic, 0, magicNumber, (int)length);
+    packDigits(&packedGuess, 0, guessed, (int)length);
+
+    size_t checksum = 0;
+    printf("length %9zu  old loops %10.1f ns", length, timeCompare(DIGIT_COMPARE_AUTO, magicNumber, guessed, formatted, length, &checksum));
+    DigitCompareKernel kernels[] = {DIGIT_COMPARE_SCALAR, DIGIT_COMPARE_SSE2, DIGIT_COMPARE_AVX2};
+    for (int k = 0; k < 3; k++)
+    {
+        if (!setDigitCompareKernel(kernels[k]))
+        {
+            continue;
+        }
+        DigitMatch match = compareDigits(magicNumber, guessed, formatted, length);
+        bool ok = match.matches == expectedMatches && match.anyMatch == (expectedMatches > 0) && memcmp(formatted, expected, length + 1) == 0;
+        printf("  %s %10.1f ns%s", digitCompareKernelName(), timeCompare(kernels[k], magicNumber, guessed, formatted, length, &checksum), ok ? "" : " WRONG");
+
+        // The packed compare must give the same display once it is unpacked
+        match = compareDigitWords(packedMagic.words, packedGuess.words, packedFormatted.words, length);
+        unpackDigits(&packedFormatted, 0, (int)length, formatted);
+        ok = match.matches == expectedMatches && memcmp(formatted, expected, length + 1) == 0;
+        printf(" packed %10.1f ns%s", timePackedCompare(&packedMagic, &packedGuess, &packedFormatted, length, &checksum), ok ? "" : " WRONG");
+    }
+    printf("  (checksum %zu)\n", checksum);
+    free(magicNumber);
+    free(guessed);
+    free(expected);
+    free(formatted);
+    freeDigitBuffer(&packedMagic);
+    freeDigitBuffer(&packedGuess);
+    freeDigitBuffer(&packedFormatted);
+}
+
+// Function to check and time the histogram kernels on one length
+static void benchHistogram(DigitRng *rng, size_t length)
+{
+    DigitBuffer digits = {NULL, 0};
+    if (!reserveDigitBuffer(&digits, (int)length))
+    {
+        printf("Out of memory for length %zu\n", length);
+        return;
+    }
+    randomDigitBuffer(rng, &digits, (int)length);
+
+    size_t expected[DIGIT_VALUES] = {0};
+    for (size_t i = 0; i < length; i++)
+    {
+        expected[getDigit(&digits, (int)i)]++;
+    }
+
+    printf("histogram length %9zu", length);
+    DigitCompareKernel kernels[] = {DIGIT_COMPARE_SCALAR, DIGIT_COMPARE_SSE2, DIGIT_COMPARE_AVX2};
+    for (int k = 0; k < 3; k++)
+    {
+        if (!setDigitCompareKernel(kernels[k]))
+        {
+            continue;
+        }
+        size_t counts[DIGIT_VALUES] = {0};
+        countDigitWords(digits.words, length, counts);
+        bool ok = memcmp(counts, expected, sizeof(counts)) == 0;
+
+        long long rounds = TOTAL_DIGITS / (long long)length;
+        clock_t start = clock();
+        for (long long r = 0; r < rounds; r++)
+        {
+            countDigitWords(digits.words, length, counts);
+        }
+        printf("  %s %10.1f ns%s", digitCompareKernelName(), secondsSince(start) * 1e9 / rounds, ok ? "" : " WRONG");
+    }
+    printf("\n");
+    freeDigitBuffer(&digits);
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+    DigitRng rng;
+    seedRng(&rng, argc > 1 ? strtoull(argv[1], NULL, 10) : 12345);
+
+    // Every length around the block sizes catches a wrong tail
+    for (size_t length = 1; length <= 100; length++)
+    {
+        char magicNumber[101], guessed[101], expected[101], formatted[101];
+        randomDigits(&rng, magicNumber, (int)length);
+        memcpy(guessed, magicNumber, length);
+        guessed[length / 2] = guessed[length / 2] == '0' ? '1' : '0';
+        oldCompare(magicNumber, guessed, expected, length);
+        for (int k = DIGIT_COMPARE_SCALAR; k <= DIGIT_COMPARE_AVX2; k++)
+        {
+            if (setDigitCompareKernel((DigitCompareKernel)k) && (compareDigits(magicNumber, guessed, formatted, length).matches != length - 1 || memcmp(formatted, expected, length + 1) != 0))
+            {
+                printf("%s kernel is wrong at length %zu!\n", digitCompareKernelName(), length);
+                return 1;
+            }
+        }
+    }
+
+    size_t lengths[] = {4, 6, 64, 256, 1000, 100000, 1000000, 10000000};
+    for (int i = 0; i < (int)(sizeof(lengths) / sizeof(lengths[0])); i++)
+    {
+        benchLength(&rng, lengths[i]);
+    }
+    for (int i = 2; i < (int)(sizeof(lengths) / sizeof(lengths[0])); i++)
+    {
+        benchHistogram(&rng, lengths[i]);
+    }
+    setDigitCompareKernel(DIGIT_COMPARE_AUTO);
+    printf("the game uses the %s kernel\n", digitCompareKernelName());
+    return 0;
+}
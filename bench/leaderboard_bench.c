@@ -0,0 +1,165 @@
+// Scaling benchmark for the leaderboard engine
+// Fills a score store with N players, then times reopening it (mapping,
+// checksum, journal replay and top-K pass), streaming every record against
+// scanning one column of the score table, submitting runs and compacting the
+// journal into a new snapshot, and reports the table's memory per million players
+// Build with "make bench" and run .\bench\leaderboard_bench.exe [N ...]
+
+#include "../leaderboard.h"
+#include "../prng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_FILE "bench_leaderboard.dat"
+#define BENCH_JOURNAL BENCH_FILE SCORE_JOURNAL_SUFFIX
+#define BENCH_TOP 100
+#define BENCH_SUBMITS 100000
+#define BENCH_RANK_QUERIES 100000
+
+// Function to get the elapsed seconds since start
+static double secondsSince(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+// Function to make a run with a ratio rounded to 2 decimals, like the game saves
+static double randomRatio(DigitRng *rng)
+{
+    return (double)(nextRandom(rng) % 10001) / 100.0;
+}
+
+// Function to add up ratios while streaming, so the pass cannot be optimized away
+static bool sumRatios(const ScoreRecord *record, uint64_t slot, void *context)
+{
+    (void)slot;
+    *(double *)context += record->successRatio;
+    return true;
+}
+
+// Function to run the benchmark for one leaderboard size
+static void benchSize(long long players)
+{
+    remove(BENCH_FILE);
+    remove(BENCH_JOURNAL);
+    DigitRng rng;
+    seedRng(&rng, (uint64_t)players);
+    char username[SCORE_NAME_SIZE];
+
+    // Bulk load without syncing every write, then flush once
+    Leaderboard leaderboard;
+    if (!openLeaderboard(&leaderboard, BENCH_FILE, NULL, BENCH_TOP))
+    {
+        return;
+    }
+    setScoreStoreSync(&leaderboard.store, false);
+    clock_t start = clock();
+    for (long long i = 0; i < players; i++)
+    {
+        snprintf(username, sizeof(username), "player%lld", i);
+        submitScore(&leaderboard, username, (int)(nextRandom(&rng) % 600), randomRatio(&rng));
+    }
+    flushScoreStore(&leaderboard.store);
+    double loadSeconds = secondsSince(start);
+    closeLeaderboard(&leaderboard);
+
+    // Reopen: one mapping, one checksum pass, the journal replay and one top-K pass
+    start = clock();
+    if (!openLeaderboard(&leaderboard, BENCH_FILE, NULL, BENCH_TOP))
+    {
+        return;
+    }
+    double openSeconds = secondsSince(start);
+
+    start = clock();
+    double total = 0.0;
+    forEachScore(&leaderboard.store, sumRatios, &total);
+    double streamSeconds = secondsSince(start);
+
+    // The same kind of question asked of one column: the ratio filter reads 8 bytes a player, not 72
+    start = clock();
+    uint64_t inRange = countScoresInRange(&leaderboard.table, 50.0, 75.0);
+    double columnSeconds = secondsSince(start);
+
+    // Submissions from existing and new players, with the top-K kept current
+    setScoreStoreSync(&leaderboard.store, false);
+    start = clock();
+    for (int i = 0; i < BENCH_SUBMITS; i++)
+    {
+        snprintf(username, sizeof(username), "player%lld", (long long)(nextRandom(&rng) % (uint64_t)(players + players / 10 + 1)));
+        submitScore(&leaderboard, username, (int)(nextRandom(&rng) % 600), randomRatio(&rng));
+    }
+    double submitSeconds = secondsSince(start);
+
+    // Fold the journal into a new snapshot and wait for the rename
+    start = clock();
+    compactScoreStore(&leaderboard.store, true);
+    double compactSeconds = secondsSince(start);
+
+    // Rank index: one build, then rank, neighbour and percentile queries
+    start = clock();
+    uint64_t rank = 0;
+    snprintf(username, sizeof(username), "player%lld", players / 2);
+    leaderboardRank(&leaderboard, username, &rank);
+    double rankBuildSeconds = secondsSince(start);
+
+    // A single rank without the index: one pass over the key column
+    start = clock();
+    long long middle = findScore(&leaderboard.store, username);
+    uint64_t scanRank = middle >= 0 ? countKeysAbove(&leaderboard.table, leaderboard.table.keys[middle]) + 1 : 0;
+    double rankScanSeconds = secondsSince(start);
+
+    start = clock();
+    uint64_t rankSum = 0;
+    for (int i = 0; i < BENCH_RANK_QUERIES; i++)
+    {
+        snprintf(username, sizeof(username), "player%lld", (long long)(nextRandom(&rng) % (uint64_t)players));
+        if (leaderboardRank(&leaderboard, username, &rank))
+        {
+            ScoreRow rows[5];
+            uint64_t firstRank;
+            rankSum += leaderboardAround(&leaderboard, rank, 2, rows, &firstRank) + firstRank;
+            rankSum += (uint64_t)rankPercentile(rank, leaderboardSize(&leaderboard));
+        }
+    }
+    double rankSeconds = secondsSince(start);
+
+    ScoreRow best;
+    leaderboardTopRow(&leaderboard, 0, &best);
+    ScoreTableFootprint footprint;
+    measureScoreTable(&leaderboard.table, &footprint);
+    double perMillion = 1e6 / 1048576.0 / (double)leaderboard.table.count;
+    printf("%10lld players  load %7.2f s  open %8.3f ms  stream %8.3f ms  submit %6.2f us/op  compact %8.3f ms  top %.2f%%  file %.1f MB  (sum %.0f)\n",
+           players, loadSeconds, openSeconds * 1000, streamSeconds * 1000, submitSeconds * 1e6 / BENCH_SUBMITS, compactSeconds * 1000,
+           best.successRatio, leaderboard.store.file.size / 1048576.0, total);
+    printf("%10s          ratio column filter %8.3f ms  (%llu in range)  rank by key column scan %8.3f ms  (rank %llu)\n",
+           "", columnSeconds * 1000, (unsigned long long)inRange, rankScanSeconds * 1000, (unsigned long long)scanRank);
+    printf("%10s          rank index build %8.3f ms  rank + 5 neighbours + percentile %6.2f us/query  (sum %llu)\n",
+           "", rankBuildSeconds * 1000, rankSeconds * 1e6 / BENCH_RANK_QUERIES, (unsigned long long)rankSum);
+    printf("%10s          table MB per million players: keys %.1f  ratios %.1f  times %.1f  name ids %.1f  name pool %.1f  total %.1f  (records %.1f)\n",
+           "", footprint.keys * perMillion, footprint.ratios * perMillion, footprint.times * perMillion, footprint.nameIds * perMillion,
+           footprint.namePool * perMillion, footprint.total * perMillion, sizeof(ScoreRecord) * 1e6 / 1048576.0);
+    closeLeaderboard(&leaderboard);
+    remove(BENCH_FILE);
+    remove(BENCH_JOURNAL);
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            benchSize(atoll(argv[i]));
+        }
+        return 0;
+    }
+
+    long long sizes[] = {1000, 100000, 10000000};
+    for (int i = 0; i < 3; i++)
+    {
+        benchSize(sizes[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,390 @@
+// Throughput benchmark for the leaderboard daemon
+// Fills a score store with N players, starts ./leaderboardd on it, then has
+// several connections send pipelined requests for a few seconds per mix
+// (rank-of, top-N, around-me, submit) and reports requests per second.
+// A second pass restarts the daemon with different commit windows and has
+// many sessions submit one run at a time, reporting submits per second and
+// how long each waited for its durable acknowledgement
+// Linux only; build with "make leaderboardd" and run ./bench/leaderboardd_bench [N]
+
+#include "../leaderboard.h"
+#include "../leaderboard_client.h"
+#include "../prng.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_FILE "bench_daemon.dat"
+#define BENCH_JOURNAL BENCH_FILE SCORE_JOURNAL_SUFFIX
+#define BENCH_SOCKET "bench_daemon.sock"
+#define BENCH_CONNECTIONS 4
+#define BENCH_PIPELINE 64
+#define BENCH_SECONDS 2.0
+#define BENCH_SESSIONS 64
+#define BENCH_MAX_SAMPLES (1 << 20)
+
+// Commit settings the daemon is restarted with for the window sweep
+typedef struct
+{
+    const char *name;
+    const char *window;
+    const char *batch;
+} BenchCommit;
+
+// Request mixes, in percent of rank-of, top-N, around-me and submit
+typedef struct
+{
+    const char *name;
+    int rank;
+    int top;
+    int around;
+    int submit;
+} BenchMix;
+
+// Function to get a monotonic wall clock in seconds
+static double wallSeconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Function to fill the store the daemon will serve, without syncing every write
+static bool fillStore(long long players)
+{
+    remove(BENCH_FILE);
+    remove(BENCH_JOURNAL);
+    Leaderboard leaderboard;
+    if (!openLeaderboard(&leaderboard, BENCH_FILE, NULL, 1))
+    {
+        return false;
+    }
+    setScoreStoreSync(&leaderboard.store, false);
+    DigitRng rng;
+    seedRng(&rng, (uint64_t)players);
+    char username[SCORE_NAME_SIZE];
+    for (long long i = 0; i < players; i++)
+    {
+        snprintf(username, sizeof(username), "player%lld", i);
+        submitScore(&leaderboard, username, (int)(nextRandom(&rng) % 600), (double)(nextRandom(&rng) % 10001) / 100.0);
+    }
+    compactScoreStore(&leaderboard.store, true);
+    closeLeaderboard(&leaderboard);
+    return true;
+}
+
+// Function to start the daemon with the given commit settings and wait until it accepts connections
+static pid_t startDaemon(LeaderboardClient clients[], int count, const char *window, const char *batch)
+{
+    pid_t daemon = fork();
+    if (daemon == 0)
+    {
+        execl("./leaderboardd", "leaderboardd", "--unix", BENCH_SOCKET, "--file", BENCH_FILE, "--window", window, "--batch", batch, (char *)NULL);
+        _exit(127);
+    }
+    for (int attempt = 0; daemon > 0 && attempt < 3000; attempt++)
+    {
+        if (connectLeaderboardClient(&clients[0], "unix:" BENCH_SOCKET))
+        {
+            for (int i = 1; i < count; i++)
+            {
+                connectLeaderboardClient(&clients[i], "unix:" BENCH_SOCKET);
+            }
+            return daemon;
+        }
+        usleep(10000);
+    }
+    printf("./leaderboardd could not be started\n");
+    return -1;
+}
+
+// Function to write one request of the mix into a buffer; returns its size
+static size_t writeRequest(char *out, const BenchMix *mix, DigitRng *rng, long long players)
+{
+    LeaderboardHeader header = {MESSAGE_RANK, 0, SCORE_NAME_SIZE};
+    LeaderboardRow row;
+    memset(&row, 0, sizeof(row));
+    snprintf(row.username, sizeof(row.username), "player%lld", (long long)(nextRandom(rng) % (uint64_t)players));
+    int pick = (int)(nextRandom(rng) % 100);
+    if (pick < mix->top)
+    {
+        header.type = MESSAGE_TOP;
+        header.count = 5;
+        header.size = 0;
+    }
+    else if (pick < mix->top + mix->around)
+    {
+        header.type = MESSAGE_AROUND;
+        header.count = 2;
+    }
+    else if (pick < mix->top + mix->around + mix->submit)
+    {
+        header.type = MESSAGE_SUBMIT;
+        header.size = sizeof(row);
+        row.time = (int)(nextRandom(rng) % 600);
+        row.successRatio = (double)(nextRandom(rng) % 10001) / 100.0;
+    }
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), &row, header.size);
+    return sizeof(header) + header.size;
+}
+
+// Function to write a submit for a player who is not on the leaderboard yet, so it always has to be saved
+static size_t writeNewRun(char *out, DigitRng *rng, uint64_t number)
+{
+    LeaderboardHeader header = {MESSAGE_SUBMIT, 0, sizeof(LeaderboardRow)};
+    LeaderboardRow row;
+    memset(&row, 0, sizeof(row));
+    snprintf(row.username, sizeof(row.username), "newcomer%llu", (unsigned long long)number);
+    row.time = (int)(nextRandom(rng) % 600);
+    row.successRatio = (double)(nextRandom(rng) % 10001) / 100.0;
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), &row, sizeof(row));
+    return sizeof(header) + sizeof(row);
+}
+
+// Function to read replies until count of them have arrived; false if the connection failed
+static bool readReplies(LeaderboardClient *client, int count, char *buffer, size_t capacity, uint64_t *errors)
+{
+    size_t used = 0;
+    while (count > 0)
+    {
+        ssize_t got = recv(client->socket, buffer + used, capacity - used, 0);
+        if (got <= 0)
+        {
+            return false;
+        }
+        used += (size_t)got;
+        size_t done = 0;
+        LeaderboardHeader header;
+        while (count > 0 && used - done >= sizeof(header))
+        {
+            memcpy(&header, buffer + done, sizeof(header));
+            if (used - done < sizeof(header) + header.size)
+            {
+                break;
+            }
+            *errors += header.type == MESSAGE_ERROR;
+            done += sizeof(header) + header.size;
+            count--;
+        }
+        memmove(buffer, buffer + done, used - done);
+        used -= done;
+    }
+    return true;
+}
+
+// Function to run one mix for a fixed time over every connection; returns requests per second
+static double runMix(LeaderboardClient clients[], const BenchMix *mix, long long players, uint64_t *errors)
+{
+    static char requests[BENCH_PIPELINE * (sizeof(LeaderboardHeader) + sizeof(LeaderboardRow))];
+    static char replies[BENCH_PIPELINE * LEADERBOARD_MAX_MESSAGE];
+    DigitRng rng;
+    seedRng(&rng, 42);
+    uint64_t done = 0;
+    double start = wallSeconds();
+    while (wallSeconds() - start < BENCH_SECONDS)
+    {
+        // Every connection gets a full pipeline before any replies are read, so the daemon always has work queued
+        for (int c = 0; c < BENCH_CONNECTIONS; c++)
+        {
+            size_t size = 0;
+            for (int i = 0; i < BENCH_PIPELINE; i++)
+            {
+                size += writeRequest(requests + size, mix, &rng, players);
+            }
+            if (send(clients[c].socket, requests, size, MSG_NOSIGNAL) != (ssize_t)size)
+            {
+                return 0.0;
+            }
+        }
+        for (int c = 0; c < BENCH_CONNECTIONS; c++)
+        {
+            if (!readReplies(&clients[c], BENCH_PIPELINE, replies, sizeof(replies), errors))
+            {
+                return 0.0;
+            }
+        }
+        done += BENCH_CONNECTIONS * BENCH_PIPELINE;
+    }
+    return done / (wallSeconds() - start);
+}
+
+// Function to stop the daemon after closing every connection to it
+static void stopDaemon(pid_t daemon, LeaderboardClient clients[], int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        closeLeaderboardClient(&clients[i]);
+    }
+    kill(daemon, SIGTERM);
+    waitpid(daemon, NULL, 0);
+}
+
+// Function to compare two latencies for qsort
+static int compareLatency(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Function to have every session submit one run at a time for a fixed time;
+// returns submits per second and fills in the 50th and 99th percentile wait
+static double runSessions(LeaderboardClient clients[], uint64_t *newcomers, double *p50, double *p99, uint64_t *errors)
+{
+    static double samples[BENCH_MAX_SAMPLES];
+    char request[sizeof(LeaderboardHeader) + sizeof(LeaderboardRow)];
+    char reply[LEADERBOARD_MAX_MESSAGE];
+    double sentAt[BENCH_SESSIONS];
+    struct pollfd fds[BENCH_SESSIONS];
+    DigitRng rng;
+    seedRng(&rng, 7);
+    uint64_t done = 0;
+
+    double start = wallSeconds();
+    for (int c = 0; c < BENCH_SESSIONS; c++)
+    {
+        size_t size = writeNewRun(request, &rng, (*newcomers)++);
+        fds[c].fd = clients[c].socket;
+        fds[c].events = POLLIN;
+        sentAt[c] = wallSeconds();
+        if (send(clients[c].socket, request, size, MSG_NOSIGNAL) != (ssize_t)size)
+        {
+            return 0.0;
+        }
+    }
+
+    // A session sends its next run as soon as the previous one is acknowledged
+    while (wallSeconds() - start < BENCH_SECONDS)
+    {
+        if (poll(fds, BENCH_SESSIONS, 1000) <= 0)
+        {
+            return 0.0;
+        }
+        for (int c = 0; c < BENCH_SESSIONS; c++)
+        {
+            if (!(fds[c].revents & POLLIN))
+            {
+                continue;
+            }
+            if (!readReplies(&clients[c], 1, reply, sizeof(reply), errors))
+            {
+                return 0.0;
+            }
+            double now = wallSeconds();
+            if (done < BENCH_MAX_SAMPLES)
+            {
+                samples[done] = now - sentAt[c];
+            }
+            done++;
+            size_t size = writeNewRun(request, &rng, (*newcomers)++);
+            sentAt[c] = now;
+            if (send(clients[c].socket, request, size, MSG_NOSIGNAL) != (ssize_t)size)
+            {
+                return 0.0;
+            }
+        }
+    }
+    double elapsed = wallSeconds() - start;
+
+    // Drain the last runs so the next daemon starts on a quiet journal
+    for (int c = 0; c < BENCH_SESSIONS; c++)
+    {
+        readReplies(&clients[c], 1, reply, sizeof(reply), errors);
+    }
+
+    uint64_t count = done < BENCH_MAX_SAMPLES ? done : BENCH_MAX_SAMPLES;
+    qsort(samples, count, sizeof(double), compareLatency);
+    *p50 = count > 0 ? samples[count / 2] : 0.0;
+    *p99 = count > 0 ? samples[count * 99 / 100] : 0.0;
+    return done / elapsed;
+}
+
+// Function to measure submit throughput and acknowledgement latency for several commit windows
+static void sweepCommitWindow(long long players)
+{
+    BenchCommit commits[] = {
+        {"sync each", "0", "1"},
+        {"window 0", "0", "1024"},
+        {"window 250us", "250", "1024"},
+        {"window 1ms", "1000", "1024"},
+        {"window 4ms", "4000", "1024"},
+    };
+    LeaderboardClient clients[BENCH_SESSIONS];
+    uint64_t newcomers = 0;
+    for (size_t i = 0; i < sizeof(commits) / sizeof(commits[0]); i++)
+    {
+        pid_t daemon = startDaemon(clients, BENCH_SESSIONS, commits[i].window, commits[i].batch);
+        if (daemon < 0)
+        {
+            return;
+        }
+        uint64_t errors = 0;
+        double p50 = 0.0, p99 = 0.0;
+        double rate = runSessions(clients, &newcomers, &p50, &p99, &errors);
+        stopDaemon(daemon, clients, BENCH_SESSIONS);
+        printf("%10lld players  %-12s %10.0f submits/s  p50 %7.3f ms  p99 %7.3f ms  (%llu errors)\n", players, commits[i].name, rate, p50 * 1e3, p99 * 1e3, (unsigned long long)errors);
+    }
+}
+
+// Function to run every mix against a daemon serving the given number of players
+static void benchSize(long long players)
+{
+    if (!fillStore(players))
+    {
+        return;
+    }
+    LeaderboardClient clients[BENCH_CONNECTIONS];
+    pid_t daemon = startDaemon(clients, BENCH_CONNECTIONS, "0", "1024");
+    if (daemon < 0)
+    {
+        return;
+    }
+
+    BenchMix mixes[] = {
+        {"rank-of", 100, 0, 0, 0},
+        {"top-5", 0, 100, 0, 0},
+        {"around-me", 0, 0, 100, 0},
+        {"mixed reads", 60, 30, 10, 0},
+        {"submit", 0, 0, 0, 100},
+    };
+    for (size_t i = 0; i < sizeof(mixes) / sizeof(mixes[0]); i++)
+    {
+        uint64_t errors = 0;
+        double rate = runMix(clients, &mixes[i], players, &errors);
+        printf("%10lld players  %-12s %10.0f requests/s  (%llu errors)\n", players, mixes[i].name, rate, (unsigned long long)errors);
+    }
+    stopDaemon(daemon, clients, BENCH_CONNECTIONS);
+
+    sweepCommitWindow(players);
+    remove(BENCH_FILE);
+    remove(BENCH_JOURNAL);
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+    signal(SIGPIPE, SIG_IGN);
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            benchSize(atoll(argv[i]));
+        }
+        return 0;
+    }
+
+    long long sizes[] = {1000, 1000000};
+    for (int i = 0; i < 2; i++)
+    {
+        benchSize(sizes[i]);
+    }
+    return 0;
+}
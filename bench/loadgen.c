@@ -0,0 +1,698 @@
+// Load generator for the game and leaderboard paths
+// Simulated players are small state machines, not threads: each one plays
+// full runs (NEW, then GUESS until the last level is solved) and submits its
+// score, either through the headless core and a leaderboard in this process,
+// or against gameserverd and leaderboardd over their sockets with every bot
+// keeping one request in flight. Reports runs and operations per second,
+// p50/p99/p999 latency per operation and error counts. Linux only
+// Build with "make loadgen" and run ./bench/loadgen [--bots N] [--seconds S] [--seed N]
+//   [--core] [--file PATH] or [--game ADDRESS] [--leaderboard ADDRESS]
+// where an ADDRESS is unix:PATH, HOST:PORT or PORT
+
+#include "../session_pool.h"
+#include "../leaderboard.h"
+#include "../leaderboard_client.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define LOADGEN_DEFAULT_BOTS 1000
+#define LOADGEN_DEFAULT_SECONDS 10.0
+#define LOADGEN_MAX_EVENTS 256
+#define LOADGEN_INPUT_SIZE 256
+
+// Latency histogram: exact below 16 ns, then 16 buckets per power of two (within about 6%)
+#define HISTOGRAM_SUB_BITS 4
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+
+// Operations whose latency and errors are reported separately
+typedef enum
+{
+    OP_NEW,
+    OP_GUESS,
+    OP_SUBMIT,
+    OP_COUNT
+} Operation;
+
+static const char *operationNames[OP_COUNT] = {"new", "guess", "submit"};
+
+// What a bot waits for or does next
+typedef enum
+{
+    BOT_START,
+    BOT_PLAYING,
+    BOT_SUBMITTING
+} BotState;
+
+// Structure to store one operation's counts and latency histogram
+typedef struct
+{
+    uint64_t count;
+    uint64_t errors;
+    uint64_t buckets[HISTOGRAM_BUCKETS];
+} OperationStats;
+
+// Structure to store one simulated player
+typedef struct
+{
+    int id;
+    BotState state;
+    int level;
+    int numberLength;
+    char known[POOL_DIGIT_BUFFER];
+    int nextDigit;
+    char guess[POOL_DIGIT_BUFFER];
+    double successRatio;
+    int attempts;
+    uint64_t runStart;
+
+    // Headless core: the session; servers: the sockets and the request in flight
+    GameSession *session;
+    int gameSocket;
+    LeaderboardClient leaderboard;
+    Operation pending;
+    uint64_t sentAt;
+    char input[LOADGEN_INPUT_SIZE];
+    size_t inputUsed;
+} Bot;
+
+// Structure to store what a guess (or NEW) told the bot
+typedef struct
+{
+    bool ok;
+    bool hit;
+    bool done;
+    char feedback[POOL_DIGIT_BUFFER];
+    int level;
+    int numberLength;
+    int attempts;
+    double successRatio;
+} Reply;
+
+// Structure to store the run's settings and results
+typedef struct
+{
+    int bots;
+    double seconds;
+    uint64_t seed;
+    const char *gameAddress;
+    const char *leaderboardAddress;
+    const char *file;
+    Leaderboard localLeaderboard;
+    bool hasLocalLeaderboard;
+    uint64_t runs;
+    OperationStats stats[OP_COUNT];
+} LoadGen;
+
+// Function to get a monotonic clock in nanoseconds
+static uint64_t nowNanos()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+// Function to find the histogram bucket of a latency
+static int bucketOf(uint64_t nanos)
+{
+    if (nanos < (1u << HISTOGRAM_SUB_BITS))
+    {
+        return (int)nanos;
+    }
+    int top = 63 - __builtin_clzll(nanos);
+    int shift = top - HISTOGRAM_SUB_BITS;
+    return ((shift + 1) << HISTOGRAM_SUB_BITS) + (int)((nanos >> shift) & ((1u << HISTOGRAM_SUB_BITS) - 1));
+}
+
+// Function to get the middle of a histogram bucket in nanoseconds
+static double bucketValue(int bucket)
+{
+    if (bucket < (1 << HISTOGRAM_SUB_BITS))
+    {
+        return bucket;
+    }
+    int shift = (bucket >> HISTOGRAM_SUB_BITS) - 1;
+    uint64_t low = ((uint64_t)((1 << HISTOGRAM_SUB_BITS) + (bucket & ((1 << HISTOGRAM_SUB_BITS) - 1)))) << shift;
+    return low + ((1ULL << shift) - 1) / 2.0;
+}
+
+// Function to count one finished operation
+static void recordOperation(LoadGen *loadGen, Operation operation, uint64_t startNanos, bool ok)
+{
+    OperationStats *stats = &loadGen->stats[operation];
+    stats->count++;
+    stats->buckets[bucketOf(nowNanos() - startNanos)]++;
+    if (!ok)
+    {
+        stats->errors++;
+    }
+}
+
+// Function to get a latency percentile (0-100) of an operation in nanoseconds
+static double percentile(const OperationStats *stats, double percent)
+{
+    uint64_t target = (uint64_t)(stats->count * percent / 100.0);
+    uint64_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        seen += stats->buckets[i];
+        if (seen > target)
+        {
+            return bucketValue(i);
+        }
+    }
+    return 0.0;
+}
+
+// Function to forget what the bot learned, for a new level of numberLength digits
+static void startBotLevel(Bot *bot, int level, int numberLength)
+{
+    bot->level = level;
+    bot->numberLength = numberLength;
+    memset(bot->known, '?', numberLength);
+    bot->known[numberLength] = '\0';
+    bot->nextDigit = 0;
+}
+
+// Function to pick the bot's next guess: one digit everywhere, until the
+// feedback has placed every digit (a 9 is never tried, it is what is left)
+static const char *nextGuess(Bot *bot)
+{
+    int length = bot->numberLength;
+    bool complete = bot->nextDigit == 9 || memchr(bot->known, '?', length) == NULL;
+    for (int i = 0; i < length; i++)
+    {
+        if (complete)
+        {
+            bot->guess[i] = bot->known[i] == '?' ? '9' : bot->known[i];
+        }
+        else
+        {
+            bot->guess[i] = (char)('0' + bot->nextDigit);
+        }
+    }
+    bot->guess[length] = '\0';
+    return bot->guess;
+}
+
+// Function to move the bot along after a reply to NEW or GUESS; false if the reply made no sense
+static bool applyReply(LoadGen *loadGen, Bot *bot, Operation operation, const Reply *reply)
+{
+    if (!reply->ok)
+    {
+        return false;
+    }
+    if (operation == OP_NEW)
+    {
+        startBotLevel(bot, reply->level, reply->numberLength);
+        bot->state = BOT_PLAYING;
+        return true;
+    }
+    if (!reply->hit)
+    {
+        for (int i = 0; i < bot->numberLength && reply->feedback[i] != '\0'; i++)
+        {
+            if (reply->feedback[i] != '-')
+            {
+                bot->known[i] = reply->feedback[i];
+            }
+        }
+        bot->nextDigit++;
+        return bot->nextDigit <= 9;
+    }
+    if (!reply->done)
+    {
+        startBotLevel(bot, reply->level, reply->numberLength);
+        return true;
+    }
+
+    // The run is over; it is submitted if there is a leaderboard, otherwise the next one starts
+    loadGen->runs++;
+    bot->successRatio = reply->successRatio;
+    bot->attempts = reply->attempts;
+    bot->state = loadGen->leaderboardAddress != NULL || loadGen->hasLocalLeaderboard ? BOT_SUBMITTING : BOT_START;
+    return true;
+}
+
+// Function to run one operation of a bot on the headless core
+static void stepCoreBot(LoadGen *loadGen, SessionPool *pool, Bot *bot, uint64_t *seed)
+{
+    uint64_t start = nowNanos();
+    Reply reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.ok = true;
+
+    if (bot->state == BOT_START)
+    {
+        if (bot->session == NULL)
+        {
+            bot->session = acquireSession(pool, (*seed)++);
+        }
+        else
+        {
+            initSession(bot->session, (*seed)++);
+        }
+        reply.ok = bot->session != NULL;
+        if (reply.ok)
+        {
+            reply.level = bot->session->level;
+            reply.numberLength = bot->session->numberLength;
+        }
+        bot->runStart = start;
+        bool ok = applyReply(loadGen, bot, OP_NEW, &reply);
+        recordOperation(loadGen, OP_NEW, start, ok);
+        return;
+    }
+
+    if (bot->state == BOT_SUBMITTING)
+    {
+        char username[SCORE_NAME_SIZE];
+        snprintf(username, sizeof(username), "bot%d", bot->id);
+        int time = (int)((start - bot->runStart) / 1000000000ULL);
+        // As in leaderboardd, a run that does not beat the bot's record is answered, not failed;
+        // only a run that could not be saved is an error
+        JournalEntry entry;
+        bool ok = true;
+        if (stageScore(&loadGen->localLeaderboard, username, time, bot->successRatio, &entry))
+        {
+            ok = writeJournal(&loadGen->localLeaderboard.store, &entry, 1);
+        }
+        bot->state = BOT_START;
+        recordOperation(loadGen, OP_SUBMIT, start, ok);
+        return;
+    }
+
+    // Enter the guess the way the keyboard (or gameserverd) does
+    GameSession *session = bot->session;
+    const char *guess = nextGuess(bot);
+    for (int i = 0; guess[i] != '\0'; i++)
+    {
+        submitDigit(session, guess[i] - '0');
+    }
+    GuessResult result = submitGuess(session);
+    reply.ok = result != GUESS_INCOMPLETE;
+    reply.hit = result == GUESS_CORRECT;
+    reply.attempts = session->attempts;
+    unpackDigits(&session->formatted, 0, session->numberLength, reply.feedback);
+    if (reply.hit && advanceLevel(session))
+    {
+        reply.level = session->level;
+        reply.numberLength = session->numberLength;
+    }
+    else if (reply.hit)
+    {
+        reply.done = true;
+        reply.successRatio = finishSession(session);
+    }
+    bool ok = applyReply(loadGen, bot, OP_GUESS, &reply);
+    recordOperation(loadGen, OP_GUESS, start, ok);
+    if (!ok)
+    {
+        bot->state = BOT_START;
+    }
+}
+
+// Function to play bots on the headless core for the configured time
+static bool runCore(LoadGen *loadGen, Bot *bots)
+{
+    SessionPool pool;
+    if (!initSessionPool(&pool, loadGen->bots))
+    {
+        printf("Session pool could not be created!\n");
+        return false;
+    }
+    uint64_t seed = loadGen->seed;
+    uint64_t end = nowNanos() + (uint64_t)(loadGen->seconds * 1e9);
+
+    // Bots take turns one operation at a time, like a server interleaving its clients
+    while (nowNanos() < end)
+    {
+        for (int i = 0; i < loadGen->bots; i++)
+        {
+            stepCoreBot(loadGen, &pool, &bots[i], &seed);
+        }
+    }
+    freeSessionPool(&pool);
+    return true;
+}
+
+// Function to connect to a game server address: unix:PATH, HOST:PORT or PORT
+static int connectGameServer(const char *address)
+{
+    if (strncmp(address, "unix:", 5) == 0)
+    {
+        struct sockaddr_un unixAddress;
+        memset(&unixAddress, 0, sizeof(unixAddress));
+        unixAddress.sun_family = AF_UNIX;
+        snprintf(unixAddress.sun_path, sizeof(unixAddress.sun_path), "%s", address + 5);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr *)&unixAddress, sizeof(unixAddress)) != 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+        return fd;
+    }
+
+    char host[256] = "127.0.0.1";
+    const char *port = address;
+    const char *colon = strrchr(address, ':');
+    if (colon != NULL)
+    {
+        snprintf(host, sizeof(host), "%.*s", (int)(colon - address), address);
+        port = colon + 1;
+    }
+    struct addrinfo hints, *found = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &found) != 0)
+    {
+        return -1;
+    }
+    int fd = -1;
+    for (struct addrinfo *candidate = found; candidate != NULL && fd < 0; candidate = candidate->ai_next)
+    {
+        fd = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+        if (fd >= 0 && connect(fd, candidate->ai_addr, candidate->ai_addrlen) != 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(found);
+    return fd;
+}
+
+// Function to send a bot's next request to the game server or the leaderboard
+static bool sendBotRequest(LoadGen *loadGen, Bot *bot)
+{
+    char request[sizeof(LeaderboardHeader) + sizeof(LeaderboardRow)];
+    int size;
+    int fd = bot->gameSocket;
+    if (bot->state == BOT_START)
+    {
+        bot->pending = OP_NEW;
+        size = snprintf(request, sizeof(request), "NEW %llu\n", (unsigned long long)(loadGen->seed + (uint64_t)bot->id * 1000003ULL + loadGen->stats[OP_NEW].count));
+    }
+    else if (bot->state == BOT_PLAYING)
+    {
+        bot->pending = OP_GUESS;
+        size = snprintf(request, sizeof(request), "GUESS %s\n", nextGuess(bot));
+    }
+    else
+    {
+        bot->pending = OP_SUBMIT;
+        LeaderboardHeader header = {MESSAGE_SUBMIT, 0, sizeof(LeaderboardRow)};
+        LeaderboardRow row;
+        memset(&row, 0, sizeof(row));
+        snprintf(row.username, sizeof(row.username), "bot%d", bot->id);
+        row.time = (int)((nowNanos() - bot->runStart) / 1000000000ULL);
+        row.successRatio = bot->successRatio;
+        memcpy(request, &header, sizeof(header));
+        memcpy(request + sizeof(header), &row, sizeof(row));
+        size = (int)(sizeof(header) + sizeof(row));
+        fd = bot->leaderboard.socket;
+    }
+    if (bot->pending == OP_NEW)
+    {
+        bot->runStart = nowNanos();
+    }
+    bot->sentAt = nowNanos();
+    bot->inputUsed = 0;
+
+    // One small request per idle socket always fits in its send buffer
+    return send(fd, request, (size_t)size, MSG_NOSIGNAL) == size;
+}
+
+// Function to parse a game server reply line
+static void parseGameReply(const char *line, Operation operation, Reply *reply)
+{
+    memset(reply, 0, sizeof(*reply));
+    if (operation == OP_NEW)
+    {
+        reply->ok = sscanf(line, "LEVEL %d %d", &reply->level, &reply->numberLength) == 2;
+        return;
+    }
+    int correct;
+    if (sscanf(line, "MISS %7s %d %d", reply->feedback, &reply->attempts, &correct) == 3)
+    {
+        reply->ok = true;
+        return;
+    }
+    int consumed = 0;
+    if (sscanf(line, "HIT %7s %d %d %n", reply->feedback, &reply->attempts, &correct, &consumed) != 3 || consumed == 0)
+    {
+        return;
+    }
+    reply->hit = true;
+    const char *rest = line + consumed;
+    if (sscanf(rest, "LEVEL %d %d", &reply->level, &reply->numberLength) == 2)
+    {
+        reply->ok = true;
+    }
+    else if (sscanf(rest, "DONE %lf", &reply->successRatio) == 1)
+    {
+        reply->ok = true;
+        reply->done = true;
+    }
+}
+
+// Function to take in what arrived for a bot; returns false if the bot's connections failed
+static bool receiveBotReply(LoadGen *loadGen, Bot *bot, int fd)
+{
+    ssize_t got = recv(fd, bot->input + bot->inputUsed, sizeof(bot->input) - 1 - bot->inputUsed, 0);
+    if (got == 0 || (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+        recordOperation(loadGen, bot->pending, bot->sentAt, false);
+        return false;
+    }
+    if (got < 0)
+    {
+        return true;
+    }
+    bot->inputUsed += (size_t)got;
+
+    bool ok;
+    if (bot->pending == OP_SUBMIT)
+    {
+        LeaderboardHeader header;
+        if (bot->inputUsed < sizeof(header))
+        {
+            return true;
+        }
+        memcpy(&header, bot->input, sizeof(header));
+        if (bot->inputUsed < sizeof(header) + header.size)
+        {
+            return true;
+        }
+        ok = header.type == MESSAGE_SUBMIT;
+        bot->state = BOT_START;
+    }
+    else
+    {
+        bot->input[bot->inputUsed] = '\0';
+        char *end = strchr(bot->input, '\n');
+        if (end == NULL)
+        {
+            return bot->inputUsed < sizeof(bot->input) - 1;
+        }
+        *end = '\0';
+        Reply reply;
+        parseGameReply(bot->input, bot->pending, &reply);
+        ok = applyReply(loadGen, bot, bot->pending, &reply);
+        if (!ok)
+        {
+            // A confused bot starts a fresh run rather than guessing on
+            bot->state = BOT_START;
+        }
+    }
+    recordOperation(loadGen, bot->pending, bot->sentAt, ok);
+    return sendBotRequest(loadGen, bot);
+}
+
+// Function to play bots against gameserverd (and leaderboardd) for the configured time
+static bool runServers(LoadGen *loadGen, Bot *bots)
+{
+    int epoll = epoll_create1(0);
+    if (epoll < 0)
+    {
+        return false;
+    }
+    for (int i = 0; i < loadGen->bots; i++)
+    {
+        Bot *bot = &bots[i];
+        bot->gameSocket = connectGameServer(loadGen->gameAddress);
+        if (bot->gameSocket < 0)
+        {
+            printf("Bot %d could not connect to %s!\n", i, loadGen->gameAddress);
+            return false;
+        }
+        if (loadGen->leaderboardAddress != NULL && !connectLeaderboardClient(&bot->leaderboard, loadGen->leaderboardAddress))
+        {
+            printf("Bot %d could not connect to %s!\n", i, loadGen->leaderboardAddress);
+            return false;
+        }
+
+        // The event's data is the bot index, with the low bit telling the two sockets apart
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u64 = (uint64_t)i << 1;
+        epoll_ctl(epoll, EPOLL_CTL_ADD, bot->gameSocket, &event);
+        if (loadGen->leaderboardAddress != NULL)
+        {
+            event.data.u64 = ((uint64_t)i << 1) | 1;
+            epoll_ctl(epoll, EPOLL_CTL_ADD, bot->leaderboard.socket, &event);
+        }
+    }
+
+    // Every bot keeps exactly one request in flight; a bot whose connection fails drops out
+    int alive = 0;
+    for (int i = 0; i < loadGen->bots; i++)
+    {
+        alive += sendBotRequest(loadGen, &bots[i]) ? 1 : 0;
+    }
+    struct epoll_event events[LOADGEN_MAX_EVENTS];
+    uint64_t end = nowNanos() + (uint64_t)(loadGen->seconds * 1e9);
+    while (alive > 0 && nowNanos() < end)
+    {
+        int ready = epoll_wait(epoll, events, LOADGEN_MAX_EVENTS, 100);
+        for (int i = 0; i < ready; i++)
+        {
+            Bot *bot = &bots[events[i].data.u64 >> 1];
+            int fd = (events[i].data.u64 & 1) ? bot->leaderboard.socket : bot->gameSocket;
+            if (!receiveBotReply(loadGen, bot, fd))
+            {
+                epoll_ctl(epoll, EPOLL_CTL_DEL, bot->gameSocket, NULL);
+                if (loadGen->leaderboardAddress != NULL)
+                {
+                    epoll_ctl(epoll, EPOLL_CTL_DEL, bot->leaderboard.socket, NULL);
+                }
+                alive--;
+            }
+        }
+    }
+    if (alive < loadGen->bots)
+    {
+        printf("%d bot(s) lost their connection\n", loadGen->bots - alive);
+    }
+
+    for (int i = 0; i < loadGen->bots; i++)
+    {
+        close(bots[i].gameSocket);
+        if (loadGen->leaderboardAddress != NULL)
+        {
+            closeLeaderboardClient(&bots[i].leaderboard);
+        }
+    }
+    close(epoll);
+    return true;
+}
+
+// Function to print throughput, latency percentiles and errors per operation
+static void printReport(const LoadGen *loadGen, double elapsed)
+{
+    printf("%d bots, %.1f s: %llu runs (%.0f runs/s)\n", loadGen->bots, elapsed, (unsigned long long)loadGen->runs, loadGen->runs / elapsed);
+    printf("%-8s %12s %12s %10s %10s %10s %8s\n", "op", "count", "ops/s", "p50 us", "p99 us", "p999 us", "errors");
+    for (int i = 0; i < OP_COUNT; i++)
+    {
+        const OperationStats *stats = &loadGen->stats[i];
+        if (stats->count == 0)
+        {
+            continue;
+        }
+        printf("%-8s %12llu %12.0f %10.2f %10.2f %10.2f %8llu\n", operationNames[i], (unsigned long long)stats->count, stats->count / elapsed, percentile(stats, 50.0) / 1e3, percentile(stats, 99.0) / 1e3, percentile(stats, 99.9) / 1e3, (unsigned long long)stats->errors);
+    }
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+    static LoadGen loadGen;
+    loadGen.bots = LOADGEN_DEFAULT_BOTS;
+    loadGen.seconds = LOADGEN_DEFAULT_SECONDS;
+    loadGen.seed = 1;
+    bool core = false;
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--core") == 0)
+        {
+            core = true;
+        }
+        else if (strcmp(argv[i], "--bots") == 0 && hasValue)
+        {
+            loadGen.bots = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seconds") == 0 && hasValue)
+        {
+            loadGen.seconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            loadGen.seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--file") == 0 && hasValue)
+        {
+            loadGen.file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--game") == 0 && hasValue)
+        {
+            loadGen.gameAddress = argv[++i];
+        }
+        else if (strcmp(argv[i], "--leaderboard") == 0 && hasValue)
+        {
+            loadGen.leaderboardAddress = argv[++i];
+        }
+    }
+    if (loadGen.bots < 1 || (!core && loadGen.gameAddress == NULL))
+    {
+        printf("Usage: loadgen [--bots N] [--seconds S] [--seed N] [--core] [--file PATH] [--game ADDRESS] [--leaderboard ADDRESS]\n");
+        return 1;
+    }
+
+    Bot *bots = (Bot *)calloc(loadGen.bots, sizeof(Bot));
+    if (bots == NULL)
+    {
+        printf("Bots could not be created!\n");
+        return 1;
+    }
+    for (int i = 0; i < loadGen.bots; i++)
+    {
+        bots[i].id = i;
+        bots[i].gameSocket = -1;
+    }
+
+    // In the core the bots submit to a leaderboard in this process, if given a file for it
+    if (core && loadGen.file != NULL)
+    {
+        loadGen.hasLocalLeaderboard = openLeaderboard(&loadGen.localLeaderboard, loadGen.file, NULL, 1);
+        if (!loadGen.hasLocalLeaderboard)
+        {
+            printf("Leaderboard %s could not be opened!\n", loadGen.file);
+        }
+    }
+
+    uint64_t start = nowNanos();
+    bool ok = core ? runCore(&loadGen, bots) : runServers(&loadGen, bots);
+    double elapsed = (nowNanos() - start) / 1e9;
+    if (ok)
+    {
+        printReport(&loadGen, elapsed);
+    }
+
+    if (loadGen.hasLocalLeaderboard)
+    {
+        closeLeaderboard(&loadGen.localLeaderboard);
+    }
+    free(bots);
+    return ok ? 0 : 1;
+}
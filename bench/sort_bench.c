@@ -0,0 +1,138 @@
+// Sorting benchmark for score tables
+// Compares qsort() over Score-like records with a double comparator (the old
+// compareScores) against the radix sort of packed keys, on one thread and on
+// every processor, and checks that all of them give the same order
+// Build with "make bench" and run .\bench\sort_bench.exe [N ...]
+
+#include "../score_key.h"
+#include "../prng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Structure laid out like the game's Score
+typedef struct
+{
+    char username[50];
+    int time;
+    double successRatio;
+    uint32_t id;
+} BenchScore;
+
+// Function to get a monotonic wall clock in seconds (clock() adds up every thread's time)
+static double wallSeconds()
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+#endif
+}
+
+// Function to compare like the key does: ratio to 2 decimals, time, then id (standing in for the sequence)
+static int compareBenchScores(const void *a, const void *b)
+{
+    const BenchScore *scoreA = (const BenchScore *)a;
+    const BenchScore *scoreB = (const BenchScore *)b;
+    long long ratioA = (long long)(scoreA->successRatio * 100.0 + 0.5);
+    long long ratioB = (long long)(scoreB->successRatio * 100.0 + 0.5);
+    if (ratioA != ratioB)
+        return ratioA < ratioB ? 1 : -1;
+    if (scoreA->time != scoreB->time)
+        return scoreA->time < scoreB->time ? -1 : 1;
+    return scoreA->id < scoreB->id ? -1 : scoreA->id > scoreB->id;
+}
+
+// Function to run the benchmark for one table size
+static void benchSize(long long count, int threads)
+{
+    BenchScore *scores = (BenchScore *)malloc(sizeof(BenchScore) * count);
+    uint64_t *keys = (uint64_t *)malloc(sizeof(uint64_t) * count);
+    uint64_t *parallelKeys = (uint64_t *)malloc(sizeof(uint64_t) * count);
+    uint32_t *order = (uint32_t *)malloc(sizeof(uint32_t) * count);
+    uint32_t *parallelOrder = (uint32_t *)malloc(sizeof(uint32_t) * count);
+    if (scores == NULL || keys == NULL || parallelKeys == NULL || order == NULL || parallelOrder == NULL)
+    {
+        printf("Out of memory for %lld scores\n", count);
+        free(scores);
+        free(keys);
+        free(parallelKeys);
+        free(order);
+        free(parallelOrder);
+        return;
+    }
+
+    // Ratios rounded to 2 decimals like the game shows them, so many tie on ratio
+    DigitRng rng;
+    seedRng(&rng, (uint64_t)count);
+    for (long long i = 0; i < count; i++)
+    {
+        snprintf(scores[i].username, sizeof(scores[i].username), "player%lld", i);
+        scores[i].time = (int)(nextRandom(&rng) % 600);
+        scores[i].successRatio = (double)(nextRandom(&rng) % 10001) / 100.0;
+        scores[i].id = (uint32_t)i;
+        keys[i] = scoreKey(scores[i].successRatio, scores[i].time, (uint64_t)i);
+        order[i] = (uint32_t)i;
+    }
+    memcpy(parallelKeys, keys, sizeof(uint64_t) * count);
+    memcpy(parallelOrder, order, sizeof(uint32_t) * count);
+
+    double start = wallSeconds();
+    qsort(scores, count, sizeof(BenchScore), compareBenchScores);
+    double qsortSeconds = wallSeconds() - start;
+
+    start = wallSeconds();
+    sortScoreKeys(keys, order, count);
+    double radixSeconds = wallSeconds() - start;
+
+    start = wallSeconds();
+    sortScoreKeysParallel(parallelKeys, parallelOrder, count, threads);
+    double parallelSeconds = wallSeconds() - start;
+
+    long long mismatches = 0;
+    for (long long i = 0; i < count; i++)
+    {
+        mismatches += order[i] != scores[i].id || parallelOrder[i] != scores[i].id;
+    }
+
+    printf("%10lld scores  qsort %9.3f ms  radix %9.3f ms  radix x%d %9.3f ms  %s\n",
+           count, qsortSeconds * 1000, radixSeconds * 1000, threads, parallelSeconds * 1000,
+           mismatches == 0 ? "same order" : "ORDER MISMATCH");
+
+    free(scores);
+    free(keys);
+    free(parallelKeys);
+    free(order);
+    free(parallelOrder);
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+    int threads = processorCount();
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            benchSize(atoll(argv[i]), threads);
+        }
+        return 0;
+    }
+
+    long long sizes[] = {1000, 100000, 1000000, 10000000};
+    for (int i = 0; i < 4; i++)
+    {
+        benchSize(sizes[i], threads);
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+// Packed decimal digits
+// Text is packed eight characters at a time: the low nibbles of the bytes
+// are pulled together by three shift-and-mask steps, so a pasted or generated
+// number of millions of digits never goes through a per-digit loop
+
+#include "digit_buffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Digits generated per call to randomDigits() while filling a buffer
+#define RANDOM_CHUNK 4096
+
+// Function to make room for length digits; the old digits are not kept, and
+// on failure the buffer is left as it was
+bool reserveDigitBuffer(DigitBuffer *buffer, int length)
+{
+    int words = DIGIT_WORDS(length);
+    uint64_t *grown = (uint64_t *)malloc(sizeof(uint64_t) * (words > 0 ? words : 1));
+    if (grown == NULL)
+    {
+        return false;
+    }
+    free(buffer->words);
+    buffer->words = grown;
+    buffer->capacity = words * DIGITS_PER_WORD;
+    return true;
+}
+
+// Function to release a buffer's words
+void freeDigitBuffer(DigitBuffer *buffer)
+{
+    free(buffer->words);
+    buffer->words = NULL;
+    buffer->capacity = 0;
+}
+
+// Function to set the first length positions, and the rest of their last word, to one digit (or DIGIT_BLANK)
+void fillDigitBuffer(DigitBuffer *buffer, int length, int digit)
+{
+    uint64_t word = 0x1111111111111111ULL * (uint64_t)digit;
+    int words = DIGIT_WORDS(length);
+    for (int i = 0; i < words; i++)
+    {
+        buffer->words[i] = word;
+    }
+}
+
+// Function to turn 8 ASCII digits into 8 packed nibbles
+static inline uint32_t packEight(const char *text)
+{
+    uint64_t x;
+    memcpy(&x, text, sizeof(x));
+    x &= 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x >> 4)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x >> 8)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+    return (uint32_t)x;
+}
+
+// Function to store count ASCII digits from text at positions first on
+void packDigits(DigitBuffer *buffer, int first, const char *text, int count)
+{
+    int i = 0;
+
+    // One digit at a time up to a word boundary, then whole words
+    for (; i < count && (first + i) % DIGITS_PER_WORD != 0; i++)
+    {
+        setDigit(buffer, first + i, text[i] - '0');
+    }
+    for (; i + DIGITS_PER_WORD <= count; i += DIGITS_PER_WORD)
+    {
+        buffer->words[(first + i) / DIGITS_PER_WORD] = (uint64_t)packEight(text + i) | ((uint64_t)packEight(text + i + 8) << 32);
+    }
+    for (; i < count; i++)
+    {
+        setDigit(buffer, first + i, text[i] - '0');
+    }
+}
+
+// Function to write count positions from first on as text ('-' for a blank), ending it with '\0'
+void unpackDigits(const DigitBuffer *buffer, int first, int count, char *text)
+{
+    for (int i = 0; i < count; i++)
+    {
+        int digit = getDigit(buffer, first + i);
+        text[i] = digit == DIGIT_BLANK ? '-' : (char)('0' + digit);
+    }
+    text[count] = '\0';
+}
+
+// Function to fill the first length positions with random digits
+void randomDigitBuffer(DigitRng *rng, DigitBuffer *buffer, int length)
+{
+    char chunk[RANDOM_CHUNK];
+    fillDigitBuffer(buffer, length, DIGIT_BLANK);
+    for (int done = 0; done < length; done += RANDOM_CHUNK)
+    {
+        int count = length - done < RANDOM_CHUNK ? length - done : RANDOM_CHUNK;
+        randomDigits(rng, chunk, count);
+        packDigits(buffer, done, chunk, count);
+    }
+}
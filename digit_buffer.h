@@ -0,0 +1,50 @@
+// Packed decimal digits
+// A number is kept as 4-bit digits, sixteen to a 64-bit word (digit i sits in
+// bits 4 * (i % 16) of word i / 16), so it takes half the memory of its text
+// and compares a word at a time. Text is only made from it to be shown
+
+#ifndef DIGIT_BUFFER_H
+#define DIGIT_BUFFER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "prng.h"
+
+#define DIGITS_PER_WORD 16
+
+// Nibble of a position that holds no digit; it is shown as '-'
+#define DIGIT_BLANK 0xF
+
+// Words needed for a number of the given length
+#define DIGIT_WORDS(length) (((length) + DIGITS_PER_WORD - 1) / DIGITS_PER_WORD)
+
+// Structure to store a packed number; capacity is in digits, a whole number of words
+typedef struct
+{
+    uint64_t *words;
+    int capacity;
+} DigitBuffer;
+
+// Function prototypes
+bool reserveDigitBuffer(DigitBuffer *buffer, int length);
+void freeDigitBuffer(DigitBuffer *buffer);
+void fillDigitBuffer(DigitBuffer *buffer, int length, int digit);
+void randomDigitBuffer(DigitRng *rng, DigitBuffer *buffer, int length);
+void packDigits(DigitBuffer *buffer, int first, const char *text, int count);
+void unpackDigits(const DigitBuffer *buffer, int first, int count, char *text);
+
+// Function to read the digit (or DIGIT_BLANK) at a position
+static inline int getDigit(const DigitBuffer *buffer, int index)
+{
+    return (int)((buffer->words[index / DIGITS_PER_WORD] >> (index % DIGITS_PER_WORD * 4)) & 0xF);
+}
+
+// Function to write the digit (or DIGIT_BLANK) at a position
+static inline void setDigit(DigitBuffer *buffer, int index, int digit)
+{
+    uint64_t *word = &buffer->words[index / DIGITS_PER_WORD];
+    int shift = index % DIGITS_PER_WORD * 4;
+    *word = (*word & ~(0xFULL << shift)) | ((uint64_t)digit << shift);
+}
+
+#endif
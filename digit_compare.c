@@ -0,0 +1,418 @@
+// Positional digit compare
+// Each kernel compares a block of digits at once and blends the guess with
+// '-' under the equality mask. Matches are counted by subtracting the mask
+// (-1 per match) from byte counters, which are summed with SAD before any of
+// them can overflow; the last partial block is finished one digit at a time.
+// Packed digits are compared the same way a nibble at a time: a byte of the
+// XOR is split into its low and high nibble, each tested against zero.
+// Histograms split the digits' own bytes the same way and test both halves
+// against every digit value, with one set of byte counters per value
+
+#include "digit_compare.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define DIGIT_COMPARE_X86 1
+#endif
+
+// Blocks a byte counter can take before it has to be summed
+#define COMPARE_COUNTER_BLOCKS 255
+
+// A packed block yields two masks per byte, so counters are summed twice as often
+#define COMPARE_PACKED_COUNTER_BLOCKS 127
+
+// Packed digits per 64-bit word, and the lowest bit of every nibble in one
+#define DIGITS_PER_COMPARE_WORD 16
+#define NIBBLE_LOW_BITS 0x1111111111111111ULL
+
+// Shorter numbers (every game level) are compared one digit, or one packed word, at a time
+#define COMPARE_MIN_VECTOR_LENGTH 16
+#define COMPARE_MIN_VECTOR_WORDS 4
+
+// A histogram clears and sums ten sets of counters, so it needs a longer run to pay off
+#define COUNT_MIN_VECTOR_WORDS 16
+
+typedef size_t (*CompareFunction)(const char *magicNumber, const char *guessed, char *formatted, size_t length);
+typedef size_t (*CompareWordsFunction)(const uint64_t *magicNumber, const uint64_t *guessed, uint64_t *formatted, size_t words);
+typedef void (*CountWordsFunction)(const uint64_t *digits, size_t words, size_t counts[DIGIT_VALUES]);
+
+// Function to compare one digit at a time; returns the number of matches
+static size_t compareScalar(const char *magicNumber, const char *guessed, char *formatted, size_t length)
+{
+    size_t matches = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        bool match = guessed[i] == magicNumber[i];
+        formatted[i] = match ? guessed[i] : '-';
+        matches += match;
+    }
+    return matches;
+}
+
+// Function to get the low bit of every nibble that differs between two packed words
+static inline uint64_t differingNibbles(uint64_t magic, uint64_t guess)
+{
+    uint64_t x = magic ^ guess;
+    return (x | (x >> 1) | (x >> 2) | (x >> 3)) & NIBBLE_LOW_BITS;
+}
+
+// Function to compare 16 packed digits per 64-bit word; returns the number of matches
+static size_t compareWordsScalar(const uint64_t *magicNumber, const uint64_t *guessed, uint64_t *formatted, size_t words)
+{
+    size_t matches = 0;
+    for (size_t i = 0; i < words; i++)
+    {
+        uint64_t differs = differingNibbles(magicNumber[i], guessed[i]);
+        formatted[i] = guessed[i] | (differs * 0xF);
+        matches += DIGITS_PER_COMPARE_WORD - (size_t)__builtin_popcountll(differs);
+    }
+    return matches;
+}
+
+// Function to add how often each digit value occurs in whole packed words to counts
+static void countWordsScalar(const uint64_t *digits, size_t words, size_t counts[DIGIT_VALUES])
+{
+    // Every nibble value has a slot, so blanks need no test
+    size_t tally[16] = {0};
+    for (size_t i = 0; i < words; i++)
+    {
+        uint64_t word = digits[i];
+        for (int j = 0; j < DIGITS_PER_COMPARE_WORD; j++)
+        {
+            tally[word & 0xF]++;
+            word >>= 4;
+        }
+    }
+    for (int d = 0; d < DIGIT_VALUES; d++)
+    {
+        counts[d] += tally[d];
+    }
+}
+
+#ifdef DIGIT_COMPARE_X86
+// Function to compare 16 digits per step with SSE2, which every x86-64 CPU has
+static size_t compareSse2(const char *magicNumber, const char *guessed, char *formatted, size_t length)
+{
+    const __m128i dash = _mm_set1_epi8('-');
+    const __m128i zero = _mm_setzero_si128();
+    __m128i counters = zero;
+    __m128i sums = zero;
+    int blocks = 0;
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i magic = _mm_loadu_si128((const __m128i *)(magicNumber + i));
+        __m128i guess = _mm_loadu_si128((const __m128i *)(guessed + i));
+        __m128i equal = _mm_cmpeq_epi8(magic, guess);
+        _mm_storeu_si128((__m128i *)(formatted + i), _mm_or_si128(_mm_and_si128(equal, guess), _mm_andnot_si128(equal, dash)));
+        counters = _mm_sub_epi8(counters, equal);
+        if (++blocks == COMPARE_COUNTER_BLOCKS)
+        {
+            sums = _mm_add_epi64(sums, _mm_sad_epu8(counters, zero));
+            counters = zero;
+            blocks = 0;
+        }
+    }
+    sums = _mm_add_epi64(sums, _mm_sad_epu8(counters, zero));
+    size_t matches = (size_t)_mm_cvtsi128_si64(sums) + (size_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums));
+    return matches + compareScalar(magicNumber + i, guessed + i, formatted + i, length - i);
+}
+
+// Function to compare 32 digits per step with AVX2
+__attribute__((target("avx2"))) static size_t compareAvx2(const char *magicNumber, const char *guessed, char *formatted, size_t length)
+{
+    const __m256i dash = _mm256_set1_epi8('-');
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i counters = zero;
+    __m256i sums = zero;
+    int blocks = 0;
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i magic = _mm256_loadu_si256((const __m256i *)(magicNumber + i));
+        __m256i guess = _mm256_loadu_si256((const __m256i *)(guessed + i));
+        __m256i equal = _mm256_cmpeq_epi8(magic, guess);
+        _mm256_storeu_si256((__m256i *)(formatted + i), _mm256_blendv_epi8(dash, guess, equal));
+        counters = _mm256_sub_epi8(counters, equal);
+        if (++blocks == COMPARE_COUNTER_BLOCKS)
+        {
+            sums = _mm256_add_epi64(sums, _mm256_sad_epu8(counters, zero));
+            counters = zero;
+            blocks = 0;
+        }
+    }
+    sums = _mm256_add_epi64(sums, _mm256_sad_epu8(counters, zero));
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    size_t matches = (size_t)_mm_cvtsi128_si64(half) + (size_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(half, half));
+    return matches + compareScalar(magicNumber + i, guessed + i, formatted + i, length - i);
+}
+
+// Function to compare 32 packed digits per step with SSE2
+static size_t compareWordsSse2(const uint64_t *magicNumber, const uint64_t *guessed, uint64_t *formatted, size_t words)
+{
+    const __m128i lowNibbles = _mm_set1_epi8(0x0F);
+    const __m128i highNibbles = _mm_set1_epi8((char)0xF0);
+    const __m128i ones = _mm_set1_epi8(-1);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i counters = zero;
+    __m128i sums = zero;
+    int blocks = 0;
+    size_t i = 0;
+    for (; i + 2 <= words; i += 2)
+    {
+        __m128i guess = _mm_loadu_si128((const __m128i *)(guessed + i));
+        __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(magicNumber + i)), guess);
+        __m128i lowEqual = _mm_cmpeq_epi8(_mm_and_si128(x, lowNibbles), zero);
+        __m128i highEqual = _mm_cmpeq_epi8(_mm_and_si128(x, highNibbles), zero);
+        __m128i equal = _mm_or_si128(_mm_and_si128(lowEqual, lowNibbles), _mm_and_si128(highEqual, highNibbles));
+        _mm_storeu_si128((__m128i *)(formatted + i), _mm_or_si128(guess, _mm_xor_si128(equal, ones)));
+        counters = _mm_sub_epi8(_mm_sub_epi8(counters, lowEqual), highEqual);
+        if (++blocks == COMPARE_PACKED_COUNTER_BLOCKS)
+        {
+            sums = _mm_add_epi64(sums, _mm_sad_epu8(counters, zero));
+            counters = zero;
+            blocks = 0;
+        }
+    }
+    sums = _mm_add_epi64(sums, _mm_sad_epu8(counters, zero));
+    size_t matches = (size_t)_mm_cvtsi128_si64(sums) + (size_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums));
+    return matches + compareWordsScalar(magicNumber + i, guessed + i, formatted + i, words - i);
+}
+
+// Function to compare 64 packed digits per step with AVX2
+__attribute__((target("avx2"))) static size_t compareWordsAvx2(const uint64_t *magicNumber, const uint64_t *guessed, uint64_t *formatted, size_t words)
+{
+    const __m256i lowNibbles = _mm256_set1_epi8(0x0F);
+    const __m256i highNibbles = _mm256_set1_epi8((char)0xF0);
+    const __m256i ones = _mm256_set1_epi8(-1);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i counters = zero;
+    __m256i sums = zero;
+    int blocks = 0;
+    size_t i = 0;
+    for (; i + 4 <= words; i += 4)
+    {
+        __m256i guess = _mm256_loadu_si256((const __m256i *)(guessed + i));
+        __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(magicNumber + i)), guess);
+        __m256i lowEqual = _mm256_cmpeq_epi8(_mm256_and_si256(x, lowNibbles), zero);
+        __m256i highEqual = _mm256_cmpeq_epi8(_mm256_and_si256(x, highNibbles), zero);
+        __m256i equal = _mm256_or_si256(_mm256_and_si256(lowEqual, lowNibbles), _mm256_and_si256(highEqual, highNibbles));
+        _mm256_storeu_si256((__m256i *)(formatted + i), _mm256_or_si256(guess, _mm256_xor_si256(equal, ones)));
+        counters = _mm256_sub_epi8(_mm256_sub_epi8(counters, lowEqual), highEqual);
+        if (++blocks == COMPARE_PACKED_COUNTER_BLOCKS)
+        {
+            sums = _mm256_add_epi64(sums, _mm256_sad_epu8(counters, zero));
+            counters = zero;
+            blocks = 0;
+        }
+    }
+    sums = _mm256_add_epi64(sums, _mm256_sad_epu8(counters, zero));
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    size_t matches = (size_t)_mm_cvtsi128_si64(half) + (size_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(half, half));
+    return matches + compareWordsScalar(magicNumber + i, guessed + i, formatted + i, words - i);
+}
+
+// Function to add SSE2 byte counters to counts and clear them
+static inline void addCountersSse2(__m128i counters[DIGIT_VALUES], size_t counts[DIGIT_VALUES])
+{
+    for (int d = 0; d < DIGIT_VALUES; d++)
+    {
+        __m128i sums = _mm_sad_epu8(counters[d], _mm_setzero_si128());
+        counts[d] += (size_t)_mm_cvtsi128_si64(sums) + (size_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums));
+        counters[d] = _mm_setzero_si128();
+    }
+}
+
+// Function to count 32 packed digits per step with SSE2
+static void countWordsSse2(const uint64_t *digits, size_t words, size_t counts[DIGIT_VALUES])
+{
+    const __m128i lowNibbles = _mm_set1_epi8(0x0F);
+    __m128i counters[DIGIT_VALUES];
+    for (int d = 0; d < DIGIT_VALUES; d++)
+    {
+        counters[d] = _mm_setzero_si128();
+    }
+    int blocks = 0;
+    size_t i = 0;
+    for (; i + 2 <= words; i += 2)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *)(digits + i));
+        __m128i low = _mm_and_si128(x, lowNibbles);
+        __m128i high = _mm_and_si128(_mm_srli_epi16(x, 4), lowNibbles);
+        for (int d = 0; d < DIGIT_VALUES; d++)
+        {
+            __m128i value = _mm_set1_epi8((char)d);
+            counters[d] = _mm_sub_epi8(_mm_sub_epi8(counters[d], _mm_cmpeq_epi8(low, value)), _mm_cmpeq_epi8(high, value));
+        }
+        if (++blocks == COMPARE_PACKED_COUNTER_BLOCKS)
+        {
+            addCountersSse2(counters, counts);
+            blocks = 0;
+        }
+    }
+    addCountersSse2(counters, counts);
+    countWordsScalar(digits + i, words - i, counts);
+}
+
+// Function to add AVX2 byte counters to counts and clear them
+__attribute__((target("avx2"))) static inline void addCountersAvx2(__m256i counters[DIGIT_VALUES], size_t counts[DIGIT_VALUES])
+{
+    for (int d = 0; d < DIGIT_VALUES; d++)
+    {
+        __m256i sums = _mm256_sad_epu8(counters[d], _mm256_setzero_si256());
+        __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+        counts[d] += (size_t)_mm_cvtsi128_si64(half) + (size_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(half, half));
+        counters[d] = _mm256_setzero_si256();
+    }
+}
+
+// Function to count 64 packed digits per step with AVX2
+__attribute__((target("avx2"))) static void countWordsAvx2(const uint64_t *digits, size_t words, size_t counts[DIGIT_VALUES])
+{
+    const __m256i lowNibbles = _mm256_set1_epi8(0x0F);
+    __m256i counters[DIGIT_VALUES];
+    for (int d = 0; d < DIGIT_VALUES; d++)
+    {
+        counters[d] = _mm256_setzero_si256();
+    }
+    int blocks = 0;
+    size_t i = 0;
+    for (; i + 4 <= words; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(digits + i));
+        __m256i low = _mm256_and_si256(x, lowNibbles);
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(x, 4), lowNibbles);
+        for (int d = 0; d < DIGIT_VALUES; d++)
+        {
+            __m256i value = _mm256_set1_epi8((char)d);
+            counters[d] = _mm256_sub_epi8(_mm256_sub_epi8(counters[d], _mm256_cmpeq_epi8(low, value)), _mm256_cmpeq_epi8(high, value));
+        }
+        if (++blocks == COMPARE_PACKED_COUNTER_BLOCKS)
+        {
+            addCountersAvx2(counters, counts);
+            blocks = 0;
+        }
+    }
+    addCountersAvx2(counters, counts);
+    countWordsScalar(digits + i, words - i, counts);
+}
+#endif
+
+static CompareFunction compareKernel = NULL;
+static CompareWordsFunction compareWordsKernel = NULL;
+static CountWordsFunction countWordsKernel = NULL;
+static DigitCompareKernel compareKernelId = DIGIT_COMPARE_AUTO;
+
+// Function to choose the compare kernel; false if the CPU cannot run the one asked for
+bool setDigitCompareKernel(DigitCompareKernel kernel)
+{
+#ifdef DIGIT_COMPARE_X86
+    __builtin_cpu_init();
+    bool hasAvx2 = __builtin_cpu_supports("avx2");
+    if (kernel == DIGIT_COMPARE_AUTO)
+    {
+        kernel = hasAvx2 ? DIGIT_COMPARE_AVX2 : DIGIT_COMPARE_SSE2;
+    }
+    if (kernel == DIGIT_COMPARE_AVX2 && !hasAvx2)
+    {
+        return false;
+    }
+    compareKernel = kernel == DIGIT_COMPARE_AVX2 ? compareAvx2 : kernel == DIGIT_COMPARE_SSE2 ? compareSse2 : compareScalar;
+    compareWordsKernel = kernel == DIGIT_COMPARE_AVX2 ? compareWordsAvx2 : kernel == DIGIT_COMPARE_SSE2 ? compareWordsSse2 : compareWordsScalar;
+    countWordsKernel = kernel == DIGIT_COMPARE_AVX2 ? countWordsAvx2 : kernel == DIGIT_COMPARE_SSE2 ? countWordsSse2 : countWordsScalar;
+#else
+    if (kernel == DIGIT_COMPARE_SSE2 || kernel == DIGIT_COMPARE_AVX2)
+    {
+        return false;
+    }
+    kernel = DIGIT_COMPARE_SCALAR;
+    compareKernel = compareScalar;
+    compareWordsKernel = compareWordsScalar;
+    countWordsKernel = countWordsScalar;
+#endif
+    compareKernelId = kernel;
+    return true;
+}
+
+// Function to get the name of the kernel in use
+const char *digitCompareKernelName()
+{
+    switch (compareKernelId)
+    {
+    case DIGIT_COMPARE_SCALAR:
+        return "scalar";
+    case DIGIT_COMPARE_SSE2:
+        return "SSE2";
+    case DIGIT_COMPARE_AVX2:
+        return "AVX2";
+    default:
+        return "not chosen yet";
+    }
+}
+
+// Function to write the masked display of guessed against magicNumber and count the matching digits
+DigitMatch compareDigits(const char *magicNumber, const char *guessed, char *formatted, size_t length)
+{
+    if (compareKernel == NULL)
+    {
+        setDigitCompareKernel(DIGIT_COMPARE_AUTO);
+    }
+    DigitMatch match;
+    match.matches = length < COMPARE_MIN_VECTOR_LENGTH ? compareScalar(magicNumber, guessed, formatted, length) : compareKernel(magicNumber, guessed, formatted, length);
+    match.anyMatch = match.matches > 0;
+    match.allMatch = match.matches == length;
+    formatted[length] = '\0';
+    return match;
+}
+
+// Function to write the packed masked display of guessed against magicNumber and count the
+// matching digits; length is in digits, and nibbles past it in the last word are not counted
+DigitMatch compareDigitWords(const uint64_t *magicNumber, const uint64_t *guessed, uint64_t *formatted, size_t length)
+{
+    if (compareWordsKernel == NULL)
+    {
+        setDigitCompareKernel(DIGIT_COMPARE_AUTO);
+    }
+    size_t words = length / DIGITS_PER_COMPARE_WORD;
+    size_t rest = length % DIGITS_PER_COMPARE_WORD;
+    DigitMatch match;
+    match.matches = words < COMPARE_MIN_VECTOR_WORDS ? compareWordsScalar(magicNumber, guessed, formatted, words) : compareWordsKernel(magicNumber, guessed, formatted, words);
+    if (rest > 0)
+    {
+        uint64_t valid = NIBBLE_LOW_BITS >> (4 * (DIGITS_PER_COMPARE_WORD - rest));
+        uint64_t differs = differingNibbles(magicNumber[words], guessed[words]);
+        formatted[words] = guessed[words] | (differs * 0xF);
+        match.matches += rest - (size_t)__builtin_popcountll(differs & valid);
+    }
+    match.anyMatch = match.matches > 0;
+    match.allMatch = match.matches == length;
+    return match;
+}
+
+// Function to add how often each digit 0-9 occurs in the first length packed
+// digits to counts; blanks are not counted
+void countDigitWords(const uint64_t *digits, size_t length, size_t counts[DIGIT_VALUES])
+{
+    if (countWordsKernel == NULL)
+    {
+        setDigitCompareKernel(DIGIT_COMPARE_AUTO);
+    }
+    size_t words = length / DIGITS_PER_COMPARE_WORD;
+    size_t rest = length % DIGITS_PER_COMPARE_WORD;
+    if (words < COUNT_MIN_VECTOR_WORDS)
+    {
+        countWordsScalar(digits, words, counts);
+    }
+    else
+    {
+        countWordsKernel(digits, words, counts);
+    }
+    for (size_t j = 0; j < rest; j++)
+    {
+        int digit = (int)((digits[words] >> (4 * j)) & 0xF);
+        if (digit < DIGIT_VALUES)
+        {
+            counts[digit]++;
+        }
+    }
+}
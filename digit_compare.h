@@ -0,0 +1,43 @@
+// Positional digit compare
+// One pass over the magic number and a guess writes the masked display
+// (matching digits kept, the rest '-' or DIGIT_BLANK) and counts the matching
+// positions, either on text or on packed 4-bit digits (see digit_buffer.h).
+// Packed digits can also be counted by value, for bulls-and-cows scoring.
+// The kernel is picked at first use: AVX2 where the CPU has it, SSE2 on any
+// other x86-64 CPU, and a plain loop elsewhere
+
+#ifndef DIGIT_COMPARE_H
+#define DIGIT_COMPARE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Digit values a histogram counts (0-9)
+#define DIGIT_VALUES 10
+
+// Compare kernels; DIGIT_COMPARE_AUTO picks the best one the CPU supports
+typedef enum
+{
+    DIGIT_COMPARE_AUTO,
+    DIGIT_COMPARE_SCALAR,
+    DIGIT_COMPARE_SSE2,
+    DIGIT_COMPARE_AVX2
+} DigitCompareKernel;
+
+// Structure to store the result of a compare
+typedef struct
+{
+    size_t matches;
+    bool anyMatch;
+    bool allMatch;
+} DigitMatch;
+
+// Function prototypes
+DigitMatch compareDigits(const char *magicNumber, const char *guessed, char *formatted, size_t length);
+DigitMatch compareDigitWords(const uint64_t *magicNumber, const uint64_t *guessed, uint64_t *formatted, size_t length);
+void countDigitWords(const uint64_t *digits, size_t length, size_t counts[DIGIT_VALUES]);
+bool setDigitCompareKernel(DigitCompareKernel kernel);
+const char *digitCompareKernelName();
+
+#endif
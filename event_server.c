@@ -0,0 +1,409 @@
+// Event loop for the daemons
+// Each connection is read until the socket is empty or replies are queued:
+// while replies wait, the client is not reading, so its further requests stay
+// in the socket. A connection is then watched for room to send, for more
+// requests, or for nothing while all its replies are held back
+
+#include "event_server.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define EVENT_MAX_EVENTS 256
+
+static volatile sig_atomic_t stopping = 0;
+
+// Function to stop the event loop on SIGINT or SIGTERM
+static void stopServer(int signal)
+{
+    (void)signal;
+    stopping = 1;
+}
+
+// Function to stop on SIGINT or SIGTERM and to survive clients that hang up mid-reply
+void catchStopSignals()
+{
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stopServer;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+}
+
+// Function to check whether SIGINT or SIGTERM has arrived
+bool stopRequested()
+{
+    return stopping != 0;
+}
+
+// Function to set up a server with no listeners yet
+void initEventServer(EventServer *server, size_t inputSize, size_t initialOutput, EventHandlers handlers, void *owner)
+{
+    memset(server, 0, sizeof(*server));
+    server->epoll = -1;
+    server->inputSize = inputSize;
+    server->initialOutput = initialOutput;
+    server->handlers = handlers;
+    server->owner = owner;
+}
+
+// Function to make a socket non-blocking
+static bool setNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Function to register a socket with epoll for the given events
+static bool watchConnection(EventServer *server, EventConnection *connection, uint32_t events, int operation)
+{
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.ptr = connection;
+    return epoll_ctl(server->epoll, operation, connection->fd, &event) == 0;
+}
+
+// Function to wrap a bound socket in a listening connection
+static EventConnection *newListener(int fd, bool isTcp)
+{
+    if (listen(fd, SOMAXCONN) != 0 || !setNonBlocking(fd))
+    {
+        close(fd);
+        return NULL;
+    }
+    EventConnection *connection = (EventConnection *)calloc(1, sizeof(EventConnection));
+    if (connection == NULL)
+    {
+        close(fd);
+        return NULL;
+    }
+    connection->fd = fd;
+    connection->listening = true;
+    connection->isTcp = isTcp;
+    return connection;
+}
+
+// Function to open a listening socket on a Unix domain socket path
+static EventConnection *listenUnix(const char *path)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        return NULL;
+    }
+    strcpy(address.sun_path, path);
+
+    // A socket file left by a daemon that did not shut down cleanly would make bind fail
+    unlink(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    return newListener(fd, false);
+}
+
+// Function to open a listening socket on a localhost TCP port
+static EventConnection *listenTcp(int port)
+{
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    return newListener(fd, true);
+}
+
+// Function to open the listening sockets asked for; false if neither could be opened
+bool openListeners(EventServer *server, const char *unixPath, int port)
+{
+    if (unixPath != NULL && (server->listeners[0] = listenUnix(unixPath)) == NULL)
+    {
+        printf("Unix socket %s could not be opened!\n", unixPath);
+    }
+    if (port != 0 && (server->listeners[1] = listenTcp(port)) == NULL)
+    {
+        printf("TCP port %d could not be opened!\n", port);
+    }
+    server->unixPath = server->listeners[0] != NULL ? unixPath : NULL;
+    return server->listeners[0] != NULL || server->listeners[1] != NULL;
+}
+
+// Function to close the listening sockets and remove the Unix socket file
+void closeListeners(EventServer *server)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        if (server->listeners[i] != NULL)
+        {
+            close(server->listeners[i]->fd);
+            free(server->listeners[i]);
+            server->listeners[i] = NULL;
+        }
+    }
+    if (server->unixPath != NULL)
+    {
+        unlink(server->unixPath);
+        server->unixPath = NULL;
+    }
+}
+
+// Function to create the epoll instance and watch the listeners; listenFlags
+// is added to their events (EPOLLEXCLUSIVE when several processes share them)
+bool startEventLoop(EventServer *server, uint32_t listenFlags)
+{
+    server->epoll = epoll_create1(0);
+    if (server->epoll < 0)
+    {
+        return false;
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        if (server->listeners[i] != NULL)
+        {
+            watchConnection(server, server->listeners[i], EPOLLIN | listenFlags, EPOLL_CTL_ADD);
+        }
+    }
+    return true;
+}
+
+// Function to watch a descriptor that is not a connection, such as a timer;
+// the woken callback is called when it is readable
+bool watchEventSource(EventServer *server, int fd)
+{
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    return epoll_ctl(server->epoll, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+// Function to close the epoll instance; client connections close with the process
+void closeEventLoop(EventServer *server)
+{
+    if (server->epoll >= 0)
+    {
+        close(server->epoll);
+        server->epoll = -1;
+    }
+}
+
+// Function to close a connection and free its buffers
+void closeEventConnection(EventServer *server, EventConnection *connection)
+{
+    if (server->handlers.closed != NULL)
+    {
+        server->handlers.closed(server->owner, connection);
+    }
+    close(connection->fd);
+    free(connection->input);
+    free(connection->output);
+    free(connection);
+}
+
+// Function to accept the connections waiting on a listening socket, up to one batch
+static void acceptConnections(EventServer *server, EventConnection *listener)
+{
+    for (int accepted = 0; server->acceptBatch == 0 || accepted < server->acceptBatch; accepted++)
+    {
+        // Other processes may wait on the same socket, so it may already be empty
+        int fd = accept4(listener->fd, NULL, NULL, SOCK_NONBLOCK);
+        if (fd < 0)
+        {
+            return;
+        }
+        if (listener->isTcp)
+        {
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+        EventConnection *connection = (EventConnection *)calloc(1, sizeof(EventConnection));
+        char *input = (char *)malloc(server->inputSize);
+        char *output = (char *)malloc(server->initialOutput);
+        if (connection == NULL || input == NULL || output == NULL)
+        {
+            free(connection);
+            free(input);
+            free(output);
+            close(fd);
+            continue;
+        }
+        connection->fd = fd;
+        connection->input = input;
+        connection->output = output;
+        connection->outputCapacity = server->initialOutput;
+        server->connections++;
+        if (!watchConnection(server, connection, EPOLLIN, EPOLL_CTL_ADD))
+        {
+            closeEventConnection(server, connection);
+        }
+    }
+}
+
+// Function to make room for size more bytes of replies
+bool reserveOutput(EventConnection *connection, size_t size)
+{
+    if (connection->outputUsed + size <= connection->outputCapacity)
+    {
+        return true;
+    }
+    size_t capacity = connection->outputCapacity;
+    while (capacity < connection->outputUsed + size)
+    {
+        capacity *= 2;
+    }
+    char *output = (char *)realloc(connection->output, capacity);
+    if (output == NULL)
+    {
+        return false;
+    }
+    connection->output = output;
+    connection->outputCapacity = capacity;
+    return true;
+}
+
+// Function to send queued replies that are not held back until the socket would block; false if the connection failed
+bool flushOutput(EventConnection *connection)
+{
+    size_t ready = connection->holding ? connection->outputHeld : connection->outputUsed;
+    while (connection->outputSent < ready)
+    {
+        ssize_t sent = send(connection->fd, connection->output + connection->outputSent, ready - connection->outputSent, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        connection->outputSent += (size_t)sent;
+    }
+    if (connection->holding)
+    {
+        return true;
+    }
+    connection->outputUsed = 0;
+    connection->outputSent = 0;
+    return true;
+}
+
+// Function to wait for room to send if replies are ready, for the daemon to
+// let them go if they are held back, and otherwise for more requests
+bool rewatchConnection(EventServer *server, EventConnection *connection)
+{
+    size_t ready = connection->holding ? connection->outputHeld : connection->outputUsed;
+    uint32_t events = EPOLLIN;
+    if (connection->outputSent < ready)
+    {
+        events = EPOLLOUT;
+    }
+    else if (connection->outputUsed > 0)
+    {
+        events = 0;
+    }
+    return watchConnection(server, connection, events, EPOLL_CTL_MOD);
+}
+
+// Function to read what a client sent, answer it and send the replies; false if the connection has to be closed
+static bool serveConnection(EventServer *server, EventConnection *connection, uint32_t events)
+{
+    if (events & (EPOLLERR | EPOLLHUP))
+    {
+        return false;
+    }
+    if ((events & EPOLLOUT) && !flushOutput(connection))
+    {
+        return false;
+    }
+
+    // While replies are still queued the client is not reading, so its requests wait in the socket
+    while (connection->outputUsed == 0 && !connection->closing)
+    {
+        ssize_t got = recv(connection->fd, connection->input + connection->inputUsed, server->inputSize - connection->inputUsed, 0);
+        if (got == 0 || (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+        {
+            return false;
+        }
+        if (got < 0)
+        {
+            break;
+        }
+        connection->inputUsed += (size_t)got;
+        if (!server->handlers.received(server->owner, connection) || !flushOutput(connection))
+        {
+            return false;
+        }
+    }
+
+    // A connection the daemon is done with is closed once its last reply is out
+    if (connection->closing && connection->outputUsed == 0)
+    {
+        return false;
+    }
+    return rewatchConnection(server, connection);
+}
+
+// Function to serve every ready socket in turn until SIGINT or SIGTERM
+void runEventLoop(EventServer *server)
+{
+    struct epoll_event events[EVENT_MAX_EVENTS];
+    while (!stopping)
+    {
+        int ready = epoll_wait(server->epoll, events, EVENT_MAX_EVENTS, -1);
+        for (int i = 0; i < ready; i++)
+        {
+            EventConnection *connection = (EventConnection *)events[i].data.ptr;
+            if (connection == NULL)
+            {
+                if (server->handlers.woken != NULL)
+                {
+                    server->handlers.woken(server->owner);
+                }
+            }
+            else if (connection->listening)
+            {
+                acceptConnections(server, connection);
+            }
+            else if (!serveConnection(server, connection, events[i].events))
+            {
+                closeEventConnection(server, connection);
+            }
+            if (server->handlers.served != NULL)
+            {
+                server->handlers.served(server->owner);
+            }
+        }
+        if (server->handlers.passed != NULL)
+        {
+            server->handlers.passed(server->owner);
+        }
+    }
+}
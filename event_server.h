@@ -0,0 +1,86 @@
+// Event loop for the daemons
+// Listens on a Unix domain socket and a localhost TCP port, accepts clients
+// and moves their bytes with epoll; the daemon only parses what arrives in a
+// connection's input buffer and queues replies in its output buffer. Linux only
+
+#ifndef EVENT_SERVER_H
+#define EVENT_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Structure to store one client connection; a listening socket has no buffers
+typedef struct
+{
+    int fd;
+    bool listening;
+    bool isTcp;
+
+    // Set by the daemon to close the connection once its replies are out
+    bool closing;
+    char *input;
+    size_t inputUsed;
+    char *output;
+    size_t outputUsed;
+    size_t outputSent;
+    size_t outputCapacity;
+
+    // While holding, replies from outputHeld on are kept back until the daemon lets them go
+    bool holding;
+    size_t outputHeld;
+
+    // The daemon's own state for the connection
+    void *context;
+} EventConnection;
+
+// Structure to store the daemon's callbacks; all but received may be NULL
+typedef struct
+{
+    // Called after bytes were added to the input; answers the complete requests
+    // in it and removes them. False closes the connection
+    bool (*received)(void *owner, EventConnection *connection);
+
+    // Called just before a connection is closed and freed
+    void (*closed)(void *owner, EventConnection *connection);
+
+    // Called when a descriptor added with watchEventSource() is ready
+    void (*woken)(void *owner);
+
+    // Called after every event, and after every pass over the ready events
+    void (*served)(void *owner);
+    void (*passed)(void *owner);
+} EventHandlers;
+
+// Structure to store the listeners, the epoll instance and the callbacks
+typedef struct
+{
+    EventConnection *listeners[2];
+    const char *unixPath;
+    int epoll;
+    size_t inputSize;
+    size_t initialOutput;
+
+    // Connections taken per wakeup of a listener, 0 for all of them
+    int acceptBatch;
+    uint64_t connections;
+    EventHandlers handlers;
+    void *owner;
+} EventServer;
+
+// Function prototypes
+void initEventServer(EventServer *server, size_t inputSize, size_t initialOutput, EventHandlers handlers, void *owner);
+bool openListeners(EventServer *server, const char *unixPath, int port);
+void closeListeners(EventServer *server);
+bool startEventLoop(EventServer *server, uint32_t listenFlags);
+bool watchEventSource(EventServer *server, int fd);
+void runEventLoop(EventServer *server);
+void closeEventLoop(EventServer *server);
+void closeEventConnection(EventServer *server, EventConnection *connection);
+bool reserveOutput(EventConnection *connection, size_t size);
+bool flushOutput(EventConnection *connection);
+bool rewatchConnection(EventServer *server, EventConnection *connection);
+void catchStopSignals();
+bool stopRequested();
+
+#endif
@@ -0,0 +1,160 @@
+// File change notifications
+// The directory is watched rather than the file, because the score store
+// replaces its files with rename and a watch on the old file would go quiet
+
+#include "file_watch.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Function to split a path into its directory and the file name used as the prefix
+static void splitWatchPath(FileWatch *watch, const char *path, char *directory, size_t size)
+{
+    const char *slash = strrchr(path, '/');
+#ifdef _WIN32
+    const char *backslash = strrchr(path, '\\');
+    if (backslash && (slash == NULL || backslash > slash))
+    {
+        slash = backslash;
+    }
+#endif
+    if (slash == NULL)
+    {
+        snprintf(directory, size, ".");
+        snprintf(watch->prefix, sizeof(watch->prefix), "%s", path);
+        return;
+    }
+    snprintf(directory, size, "%.*s", (int)(slash - path + (slash == path)), path);
+    snprintf(watch->prefix, sizeof(watch->prefix), "%s", slash + 1);
+}
+
+#ifdef _WIN32
+
+// Function to start watching the files next to path
+bool openFileWatch(FileWatch *watch, const char *path)
+{
+    char directory[MAX_PATH];
+    splitWatchPath(watch, path, directory, sizeof(directory));
+    watch->handle = FindFirstChangeNotificationA(directory, FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+    return watch->handle != INVALID_HANDLE_VALUE;
+}
+
+// Function to check, without blocking, whether the files may have changed
+// since the last check; Windows does not say which file, so any change counts
+bool fileWatchChanged(FileWatch *watch)
+{
+    if (watch->handle == INVALID_HANDLE_VALUE)
+    {
+        return true;
+    }
+    if (WaitForSingleObject(watch->handle, 0) != WAIT_OBJECT_0)
+    {
+        return false;
+    }
+    FindNextChangeNotification(watch->handle);
+    return true;
+}
+
+// Function to stop watching
+void closeFileWatch(FileWatch *watch)
+{
+    if (watch->handle != INVALID_HANDLE_VALUE)
+    {
+        FindCloseChangeNotification(watch->handle);
+    }
+    watch->handle = INVALID_HANDLE_VALUE;
+}
+
+#elif defined(__linux__)
+
+// Function to start watching the files next to path
+bool openFileWatch(FileWatch *watch, const char *path)
+{
+    char directory[FILE_WATCH_NAME_SIZE];
+    splitWatchPath(watch, path, directory, sizeof(directory));
+    watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd < 0)
+    {
+        return false;
+    }
+    if (inotify_add_watch(watch->fd, directory, IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO | IN_DELETE) < 0)
+    {
+        close(watch->fd);
+        watch->fd = -1;
+        return false;
+    }
+    return true;
+}
+
+// Function to check, without blocking, whether a file starting with the
+// prefix changed since the last check; every queued event is consumed
+bool fileWatchChanged(FileWatch *watch)
+{
+    if (watch->fd < 0)
+    {
+        return true;
+    }
+
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    size_t prefixLength = strlen(watch->prefix);
+    bool changed = false;
+    for (;;)
+    {
+        ssize_t length = read(watch->fd, buffer, sizeof(buffer));
+        if (length <= 0)
+        {
+            // EAGAIN means the queue is empty; on an overflow or error assume a change
+            return changed || (length < 0 && errno != EAGAIN);
+        }
+        for (char *next = buffer; next < buffer + length;)
+        {
+            const struct inotify_event *event = (const struct inotify_event *)next;
+            if ((event->mask & IN_Q_OVERFLOW) || (event->len > 0 && strncmp(event->name, watch->prefix, prefixLength) == 0))
+            {
+                changed = true;
+            }
+            next += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+// Function to stop watching
+void closeFileWatch(FileWatch *watch)
+{
+    if (watch->fd >= 0)
+    {
+        close(watch->fd);
+    }
+    watch->fd = -1;
+}
+
+#else
+
+// Function to start watching; without a notification API every check reports a change
+bool openFileWatch(FileWatch *watch, const char *path)
+{
+    char directory[FILE_WATCH_NAME_SIZE];
+    splitWatchPath(watch, path, directory, sizeof(directory));
+    watch->fd = -1;
+    return false;
+}
+
+// Function to check whether the files may have changed since the last check
+bool fileWatchChanged(FileWatch *watch)
+{
+    (void)watch;
+    return true;
+}
+
+// Function to stop watching
+void closeFileWatch(FileWatch *watch)
+{
+    watch->fd = -1;
+}
+
+#endif
@@ -0,0 +1,33 @@
+// File change notifications
+// Tells a process that files next to a path were written, created or
+// renamed over, without polling them: inotify on Linux and directory change
+// notifications on Windows. Elsewhere every check reports a possible change
+
+#ifndef FILE_WATCH_H
+#define FILE_WATCH_H
+
+#include <stdbool.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define FILE_WATCH_NAME_SIZE 260
+
+// Structure to store a watch on every file whose name starts with a prefix
+typedef struct
+{
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    int fd;
+#endif
+    char prefix[FILE_WATCH_NAME_SIZE];
+} FileWatch;
+
+// Function prototypes
+bool openFileWatch(FileWatch *watch, const char *path);
+bool fileWatchChanged(FileWatch *watch);
+void closeFileWatch(FileWatch *watch);
+
+#endif
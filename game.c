@@ -10,13 +10,23 @@
 #include <string.h>
 #include <time.h>
 #include <SDL2/SDL_mixer.h>
+#include "text_atlas.h"
+#include "redraw.h"
+#include "game_core.h"
+#include "leaderboard_cache.h"
+#include "leaderboard_client.h"
 
 // Define constants
 #define WINDOW_HEIGHT 480
 #define WINDOW_WIDTH 720
 #define MAX_SCORES 5
-#define MAX_GAME_LEVEL 3
-#define DEFAULT_NUM_LENGTH 4
+#define LEADERBOARD_TOP 100
+#define HIGHSCORE_FILE "highscore.dat"
+#define LEGACY_HIGHSCORE_FILE "highscore.txt"
+
+// Digits of a long number shown at once; the rest is scrolled past as the player types
+#define DIGIT_WINDOW 24
+#define DEBUG_DIGITS 64
 
 // Structure to store player scores
 typedef struct
@@ -32,6 +42,7 @@ SDL_Renderer *renderer = NULL;
 SDL_Event e;
 SDL_Texture *backgroundTexture = NULL;
 TTF_Font *font = NULL;
+TextAtlas textAtlas;
 Mix_Music *bgMusic = NULL;
 SDL_Color color = {0, 0, 0};
 
@@ -39,30 +50,60 @@ SDL_Color color = {0, 0, 0};
 bool running = true;
 bool gameFinished = true;
 bool inputRunning = true;
-int gameLevel = 1;
-int number_length = DEFAULT_NUM_LENGTH;
-time_t startTime;
-int attempts = 0, correctGuesses = 0;
+Uint64 startTicks;
 int timeTaken;
 double successRatio = (double)0;
 
+// Set by --marathon: levels keep doubling in length instead of ending after three
+bool marathonMode = false;
+
+// Set by --bulls-and-cows: every guess also reports how many digits are misplaced
+bool bullsAndCowsMode = false;
+
+// Set by --server ADDRESS to use a leaderboard daemon instead of the local files
+const char *leaderboardServer = NULL;
+LeaderboardClient leaderboardClient;
+bool useServer = false;
+
 // Function prototypes
 void initSDL();
 void closeSDL();
 void loadResources();
 void closeResources();
-void randomNumber(char *magicNumber, int number_length);
-void formatGuess(const char *magicNumber, const char *guessed, char *formatted, int number_length);
 void getUsername(char *username, int maxLen);
-void gameLoop(const char *magicNumber, int number_length, const char *username, int *attempts, int *correctGuesses);
-void readHighScores(Score scores[], int *scoreCount);
+void gameLoop(GameSession *session, const char *username);
+void readHighScores(Score scores[], int maxScores, int *scoreCount);
 void saveHighScores(Score scores[], int scoreCount);
-int compareScores(const void *a, const void *b);
-void showHighScores(int *attempts, int *correctGuesses);
+bool readPlayerRank(const char *username, uint64_t *rank, uint64_t *total);
+void formatThousands(uint64_t value, char *text, int size);
+void formatDigitWindow(const DigitBuffer *digits, int length, int first, char *text, int size);
+void showHighScores(GameSession *session, const char *username);
 
 // Main function
 int main(int argc, char *argv[])
 {
+    // A fixed seed (--seed N) replays the same magic numbers, otherwise seed from the clock
+    uint64_t seed = ((uint64_t)time(NULL) << 32) ^ SDL_GetPerformanceCounter();
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--server") == 0 && i + 1 < argc)
+        {
+            leaderboardServer = argv[++i];
+        }
+        else if (strcmp(argv[i], "--marathon") == 0)
+        {
+            marathonMode = true;
+        }
+        else if (strcmp(argv[i], "--bulls-and-cows") == 0)
+        {
+            bullsAndCowsMode = true;
+        }
+    }
+
     // Initialize SDL
     initSDL();
 
@@ -75,19 +116,25 @@ int main(int argc, char *argv[])
     {
         getUsername(username, sizeof(username));
     }
-    startTime = time(NULL);
+    startTicks = SDL_GetTicks64();
 
-    // Initialize attempts and correctGuesses
-    attempts = 0;
-    correctGuesses = 0;
+    // Start a session at the first level with attempts and correctGuesses at 0
+    GameSession *session = newSession(seed);
+    if (session == NULL)
+    {
+        printf("Game session could not be created!\n");
+        closeResources();
+        closeSDL();
+        return 1;
+    }
+    setMarathon(session, marathonMode);
+    setBullsAndCows(session, bullsAndCowsMode);
 
     // Start the game loop
     while (running)
     {
-        // Generate a random magic number
-        char magicNumber[number_length + 1];
-        randomNumber(magicNumber, number_length);
-        gameLoop(magicNumber, number_length, username, &attempts, &correctGuesses);
+        // Play the current level's magic number
+        gameLoop(session, username);
 
         // Won't save user's play if not finished all 3 levels
         if (!gameFinished)
@@ -103,74 +150,32 @@ int main(int argc, char *argv[])
         }
 
         // Check if player has completed all levels
-        if (gameLevel == MAX_GAME_LEVEL)
+        if (onLastLevel(session))
         {
             // Calculate ratio and save scores
-            if (attempts > 0)
-            {
-                successRatio = (double)correctGuesses / attempts * 100.0;
-            }
-            else
-            {
-                successRatio = 0.0;
-            }
-
-            // Read existing high scores
-            Score scores[MAX_SCORES + 1];
-            int scoreCount = 0;
-            readHighScores(scores, &scoreCount);
+            successRatio = finishSession(session);
 
-            // Add the new score to the array
-            if (scoreCount < MAX_SCORES)
+            // Save the run; the leaderboard's top-K heap absorbs it in O(log K) and keeps the ordered list ready.
+            // Marathon and bulls-and-cows runs are a different game, so they stay off the leaderboard
+            if (!session->marathon && !session->bullsAndCows)
             {
-                // There's still room for a new score
-                scores[scoreCount].time = timeTaken;
-                scores[scoreCount].successRatio = successRatio;
-                strcpy(scores[scoreCount].username, username);
-                scoreCount++;
+                Score score;
+                snprintf(score.username, sizeof(score.username), "%s", username);
+                score.time = timeTaken;
+                score.successRatio = successRatio;
+                saveHighScores(&score, 1);
             }
-            else
-            {
-                // Replace the lowest score if the new one is better
-                int minIndex = 0;
-                for (int i = 1; i < scoreCount; i++)
-                {
-                    if (scores[i].successRatio < scores[minIndex].successRatio)
-                    {
-                        minIndex = i;
-                    }
-                }
-
-                if (successRatio > scores[minIndex].successRatio)
-                {
-                    scores[minIndex].time = timeTaken;
-                    scores[minIndex].successRatio = successRatio;
-                    strcpy(scores[minIndex].username, username);
-                }
-            }
-
-            // Sort the scores in descending order
-            qsort(scores, scoreCount, sizeof(Score), compareScores);
-
-            // Save the top scores
-            saveHighScores(scores, scoreCount > MAX_SCORES ? MAX_SCORES : scoreCount);
 
             // Show high scores and reset to the first level
-            showHighScores(&attempts, &correctGuesses);
-            gameLevel = 1;
-            number_length = DEFAULT_NUM_LENGTH;
+            showHighScores(session, username);
             continue;
         }
 
         // Render next level prompt
         color = {237, 170, 125};
-        SDL_Surface *messageSurface = TTF_RenderText_Solid(font, "Correct guess! Press Enter to move to next level...", color);
-        SDL_Texture *messageTexture = SDL_CreateTextureFromSurface(renderer, messageSurface);
-        SDL_Rect messageRect = {20, 100, messageSurface->w, messageSurface->h};
-        SDL_FreeSurface(messageSurface);
-        SDL_RenderCopy(renderer, messageTexture, NULL, &messageRect);
+        drawAtlasText(&textAtlas, "Correct guess! Press Enter to move to next level...", 20, 100, color);
+        flushTextAtlas(&textAtlas, renderer);
         SDL_RenderPresent(renderer);
-        SDL_DestroyTexture(messageTexture);
         while (SDL_WaitEvent(&e))
         {
             if (e.type == SDL_QUIT)
@@ -181,15 +186,26 @@ int main(int argc, char *argv[])
             }
             else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_RETURN)
             {
-                gameLevel++;
-                number_length++;
-                randomNumber(magicNumber, number_length);
+                if (!advanceLevel(session))
+                {
+                    printf("Next level could not be started!\n");
+                    gameFinished = false;
+                    running = false;
+                    break;
+                }
+
+                // Get the leaderboard and ranks ready while the last level is played
+                if (onLastLevel(session))
+                {
+                    prefetchLeaderboardCache();
+                }
                 break;
             }
         }
     }
 
     // Close resources and quit SDL
+    freeSession(session);
     closeResources();
     closeSDL();
     return 0;
@@ -313,6 +329,31 @@ void loadResources()
         exit(1);
     }
 
+    // Rasterize the font once so text drawing never goes back to SDL_ttf
+    if (!createTextAtlas(&textAtlas, renderer, font))
+    {
+        printf("Text atlas could not be created!\n");
+        TTF_CloseFont(font);
+        closeSDL();
+        exit(1);
+    }
+
+    // A reachable daemon owns the leaderboard; without one the game falls back to the local files
+    if (leaderboardServer != NULL)
+    {
+        useServer = connectLeaderboardClient(&leaderboardClient, leaderboardServer);
+        if (!useServer)
+        {
+            printf("Leaderboard server %s could not be reached, using the local leaderboard!\n", leaderboardServer);
+        }
+    }
+
+    // Load the leaderboard once; every screen after this reads it from memory
+    if (!useServer && !openLeaderboardCache(HIGHSCORE_FILE, LEGACY_HIGHSCORE_FILE, LEADERBOARD_TOP))
+    {
+        printf("Leaderboard could not be loaded, scores will not be saved!\n");
+    }
+
     // Load background texture
     SDL_Surface *backgroundSurface = SDL_LoadBMP("background.bmp");
     if (!backgroundSurface)
@@ -327,6 +368,13 @@ void loadResources()
 // Function to close resources
 void closeResources()
 {
+    // Waits for the score writer, so every saved run is on disk before exit
+    closeLeaderboardCache();
+    if (useServer)
+    {
+        closeLeaderboardClient(&leaderboardClient);
+    }
+    destroyTextAtlas(&textAtlas);
     if (font)
     {
         TTF_CloseFont(font);
@@ -337,34 +385,6 @@ void closeResources()
     }
 }
 
-// Function to generate a random magic number
-void randomNumber(char *magicNumber, int number_length)
-{
-    srand((unsigned int)time(NULL));
-    for (int i = 0; i < number_length; i++)
-    {
-        magicNumber[i] = rand() % 10 + '0';
-    }
-    magicNumber[number_length] = '\0';
-}
-
-// Function to format the guessed number
-void formatGuess(const char *magicNumber, const char *guessed, char *formatted, int number_length)
-{
-    for (int i = 0; i < number_length; i++)
-    {
-        if (guessed[i] == magicNumber[i])
-        {
-            formatted[i] = guessed[i];
-        }
-        else
-        {
-            formatted[i] = '-';
-        }
-    }
-    formatted[number_length] = '\0';
-}
-
 // Function to get the player's username
 void getUsername(char *username, int maxLen)
 {
@@ -374,9 +394,15 @@ void getUsername(char *username, int maxLen)
     bool validInput = false;
     SDL_Event e;
 
+    // Only the typed username changes on this screen
+    RedrawScheduler scheduler;
+    initRedrawScheduler(&scheduler);
+
     while (inputRunning && running)
     {
-        while (SDL_PollEvent(&e))
+        // Sleep until an event arrives, then handle everything queued
+        bool haveEvent = waitRedrawEvent(&scheduler, &e);
+        for (; haveEvent; haveEvent = SDL_PollEvent(&e))
         {
             if (e.type == SDL_QUIT)
             {
@@ -390,6 +416,7 @@ void getUsername(char *username, int maxLen)
                 if (strlen(username) < maxLen - 1)
                 {
                     strcat(username, e.text.text);
+                    markRedraw(&scheduler, REDRAW_INPUT);
                 }
             }
             else if (e.type == SDL_KEYDOWN)
@@ -397,9 +424,11 @@ void getUsername(char *username, int maxLen)
                 if (e.key.keysym.sym == SDLK_BACKSPACE && strlen(username) > 0)
                 {
                     username[strlen(username) - 1] = '\0';
+                    markRedraw(&scheduler, REDRAW_INPUT);
                 }
                 else if (e.key.keysym.sym == SDLK_RETURN)
                 {
+                    markRedraw(&scheduler, REDRAW_INPUT | REDRAW_FEEDBACK);
                     // Check for spaces in the username
                     if (strchr(username, ' ') != NULL)
                     {
@@ -418,6 +447,12 @@ void getUsername(char *username, int maxLen)
             }
         }
 
+        // Nothing changed, go back to sleep
+        if (!needsRedraw(&scheduler, REDRAW_ALL) || !inputRunning)
+        {
+            continue;
+        }
+
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
         if (backgroundTexture)
@@ -435,70 +470,59 @@ void getUsername(char *username, int maxLen)
             snprintf(promptText, sizeof(promptText), "Enter Username: %s", username);
         }
 
-        SDL_Surface *promptSurface = TTF_RenderText_Solid(font, promptText, color);
-        SDL_Texture *promptTexture = SDL_CreateTextureFromSurface(renderer, promptSurface);
-        SDL_Rect promptRect = {20, 20, promptSurface->w, promptSurface->h};
-        SDL_FreeSurface(promptSurface);
-
-        SDL_RenderCopy(renderer, promptTexture, NULL, &promptRect);
+        drawAtlasText(&textAtlas, promptText, 20, 20, color);
+        flushTextAtlas(&textAtlas, renderer);
         SDL_RenderPresent(renderer);
-        SDL_DestroyTexture(promptTexture);
-
-        SDL_Delay(10);
+        clearRedraw(&scheduler);
     }
     SDL_StopTextInput();
 }
 
 // Function to handle the game loop
-void gameLoop(const char *magicNumber, int number_length, const char *username, int *attempts, int *correctGuesses)
+void gameLoop(GameSession *session, const char *username)
 {
     // Debugging output to show the magic number (remove in the final version)
-    printf("Magic number(for debugging): %s\n", magicNumber);
-
-    // Initialize arrays to store the guessed number, formatted display, and initial display
-    char guessed[number_length + 1];
-    char formatted[number_length + 1];
-    char initialDisplay[number_length + 1];
-
-    // Set terminating character for the guessed and formatted arrays
-    guessed[number_length] = '\0';
-    formatted[number_length] = '\0';
-
-    // Initialize the initial display with dashes and guessed with spaces
-    memset(initialDisplay, '-', number_length);
-    memset(guessed, ' ', number_length);
-    memset(formatted, '-', number_length);
+    int number_length = session->numberLength;
+    char debugText[DEBUG_DIGITS + 1];
+    unpackDigits(&session->magicNumber, 0, number_length < DEBUG_DIGITS ? number_length : DEBUG_DIGITS, debugText);
+    printf("Magic number(for debugging): %s%s\n", debugText, number_length > DEBUG_DIGITS ? "..." : "");
 
-    // Terminate the initial display string
-    initialDisplay[number_length] = '\0';
-
-    // Counter to track the number of digits entered by the player
-    int DigitCount = 0;
+    // The input shows dashes once the magic number has been found
+    char initialDisplay[DIGIT_WINDOW + 1];
+    int dashCount = number_length < DIGIT_WINDOW ? number_length : DIGIT_WINDOW;
+    memset(initialDisplay, '-', dashCount);
+    initialDisplay[dashCount] = '\0';
 
     // Set the color for the text to be rendered
     SDL_Color color = {255, 153, 51};
 
-    // Initialize variables for SDL textures and rectangles
-    SDL_Texture *messageTexture = NULL;
-    SDL_Rect messageRect;
+    // Result message shown under the input, if any
+    const char *messageText = NULL;
 
-    // Create and render the username text
+    // Create the username text
     char usernameText[100];
     snprintf(usernameText, sizeof(usernameText), "Player: %s", username);
-    SDL_Surface *usernameSurface = TTF_RenderText_Solid(font, usernameText, color);
-    SDL_Texture *usernameTexture = SDL_CreateTextureFromSurface(renderer, usernameSurface);
-    SDL_Rect usernameRect = {20, 40, usernameSurface->w, usernameSurface->h};
-    // Free the surface after creating the texture
-    SDL_FreeSurface(usernameSurface);
-
-    // Create and render the level text
-    char levelText[10];
-    snprintf(levelText, sizeof(levelText), "Level: %d", gameLevel);
-    SDL_Surface *levelSurface = TTF_RenderText_Solid(font, levelText, color);
-    SDL_Texture *levelTexture = SDL_CreateTextureFromSurface(renderer, levelSurface);
-    SDL_Rect levelRect = {20, 10, levelSurface->w, levelSurface->h};
-    // Free the surface after creating the texture
-    SDL_FreeSurface(levelSurface);
+
+    // Create the level text; marathon levels also show how long the number is
+    char levelText[50];
+    char lengthText[32];
+    formatThousands((uint64_t)number_length, lengthText, sizeof(lengthText));
+    if (session->marathon)
+    {
+        snprintf(levelText, sizeof(levelText), "Level: %d (%s digits)", session->level, lengthText);
+    }
+    else
+    {
+        snprintf(levelText, sizeof(levelText), "Level: %d", session->level);
+    }
+
+    // Text that is only rebuilt when its part of the screen changes
+    char timeText[50] = "";
+    int elapsedTime = -1;
+
+    // Everything is drawn on the first frame, then only after a change
+    RedrawScheduler scheduler;
+    initRedrawScheduler(&scheduler);
 
     // Flag to keep the game loop running
     bool gameRunning = true;
@@ -506,8 +530,9 @@ void gameLoop(const char *magicNumber, int number_length, const char *username,
     // Main game loop
     while (gameRunning && running)
     {
-        // Poll for events like key presses or quitting the game
-        while (SDL_PollEvent(&e))
+        // Sleep until a key press, quit or the next second of the timer
+        bool haveEvent = waitRedrawEvent(&scheduler, &e);
+        for (; haveEvent; haveEvent = SDL_PollEvent(&e))
         {
             if (e.type == SDL_QUIT)
             {
@@ -519,79 +544,64 @@ void gameLoop(const char *magicNumber, int number_length, const char *username,
             }
             else if (e.type == SDL_KEYDOWN)
             {
-                // Handle digit input if there is still space for more digits
-                if (DigitCount < number_length)
+                // Check if a number key was pressed and add it to the guessed number;
+                // Ctrl+V pastes a whole number, which long marathon levels need
+                bool entered = false;
+                if (e.key.keysym.sym >= SDLK_0 && e.key.keysym.sym <= SDLK_9)
+                {
+                    entered = submitDigit(session, e.key.keysym.sym - SDLK_0);
+                }
+                else if (e.key.keysym.sym == SDLK_v && (e.key.keysym.mod & KMOD_CTRL) && SDL_HasClipboardText())
+                {
+                    char *clipboard = SDL_GetClipboardText();
+                    entered = clipboard != NULL && submitDigits(session, clipboard) > 0;
+                    SDL_free(clipboard);
+                }
+                else if (e.key.keysym.sym == SDLK_BACKSPACE && removeDigit(session))
+                {
+                    // Handle backspace key to remove the last entered digit
+                    markRedraw(&scheduler, REDRAW_INPUT);
+                }
+
+                if (entered)
                 {
-                    // Check if a number key was pressed
-                    if (e.key.keysym.sym >= SDLK_0 && e.key.keysym.sym <= SDLK_9)
+                    markRedraw(&scheduler, REDRAW_INPUT);
+
+                    // If the number is fully guessed, check if it's correct
+                    GuessResult result = submitGuess(session);
+                    if (result == GUESS_CORRECT)
                     {
-                        // Convert the key to a character and add it to the guessed number
-                        guessed[DigitCount] = e.key.keysym.sym - SDLK_0 + '0';
-                        DigitCount++;
-
-                        // If the number is fully guessed, check if it's correct
-                        if (DigitCount == number_length)
-                        {
-                            // Format the guessed number
-                            formatGuess(magicNumber, guessed, formatted, number_length);
-                            // Increment the attempts counter
-                            (*attempts)++;
-
-                            // Check if any digits are correct
-                            bool hasCorrectDigit = false;
-                            for (int i = 0; i < number_length; i++)
-                            {
-                                if (guessed[i] == magicNumber[i])
-                                {
-                                    hasCorrectDigit = true;
-                                    break;
-                                }
-                            }
-                            // Increment correct guesses if any digit is correct
-                            if (hasCorrectDigit)
-                            {
-                                (*correctGuesses)++;
-                            }
-
-                            const char *resultText;
-
-                            // Check if the guessed number matches the magic number
-                            if (strncmp(guessed, magicNumber, number_length) == 0)
-                            {
-                                // Stop the game loop
-                                gameRunning = false;
-                            }
-                            else
-                            {
-                                // Reset digit count
-                                DigitCount = 0;
-                                // Incorrect guess, prompt to try again
-                                resultText = "Incorrect guess. Try again!";
-                                // Clear guessed number
-                                memset(guessed, '\0', number_length);
-                            }
-
-                            // Create and render the result message
-                            SDL_Surface *messageSurface = TTF_RenderText_Solid(font, resultText, color);
-                            messageTexture = SDL_CreateTextureFromSurface(renderer, messageSurface);
-                            messageRect.x = 20;
-                            messageRect.y = 170;
-                            messageRect.w = messageSurface->w;
-                            messageRect.h = messageSurface->h;
-                            // Free the surface after creating the texture
-                            SDL_FreeSurface(messageSurface);
-                        }
+                        // Stop the game loop
+                        gameRunning = false;
+                        messageText = NULL;
+                        markRedraw(&scheduler, REDRAW_FEEDBACK);
                     }
-                    else if (e.key.keysym.sym == SDLK_BACKSPACE && DigitCount > 0)
+                    else if (result == GUESS_INCORRECT)
                     {
-                        // Handle backspace key to remove the last entered digit
-                        DigitCount--;
-                        guessed[DigitCount] = '\0';
+                        // Incorrect guess, prompt to try again
+                        messageText = "Incorrect guess. Try again!";
+                        markRedraw(&scheduler, REDRAW_FEEDBACK);
                     }
                 }
             }
         }
 
+        // Update the timer text once per second and wake up for the next one
+        Uint64 elapsedTicks = SDL_GetTicks64() - startTicks;
+        if ((int)(elapsedTicks / 1000) != elapsedTime)
+        {
+            elapsedTime = (int)(elapsedTicks / 1000);
+            snprintf(timeText, sizeof(timeText), "Time: %d s", elapsedTime);
+            markRedraw(&scheduler, REDRAW_TIMER);
+        }
+        setRedrawDeadline(&scheduler, startTicks + (Uint64)(elapsedTime + 1) * 1000);
+
+        // Nothing on the screen changed, go back to sleep
+        if (!needsRedraw(&scheduler, REDRAW_ALL) || !gameRunning || !running)
+        {
+            continue;
+        }
+
         // Render everything to the screen
         // Set background color to black
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
@@ -605,186 +615,189 @@ void gameLoop(const char *magicNumber, int number_length, const char *username,
         }
 
         // Render the username text
-        SDL_RenderCopy(renderer, usernameTexture, NULL, &usernameRect);
-
-        // Create and render the formatted guessed number
-        char displayText[number_length + 20];
-        snprintf(displayText, sizeof(displayText), "Guess: %s", formatted);
-        SDL_Surface *displaySurface = TTF_RenderText_Solid(font, displayText, color);
-        SDL_Texture *displayTexture = SDL_CreateTextureFromSurface(renderer, displaySurface);
-        SDL_Rect displayRect = {20, 100, displaySurface->w, displaySurface->h};
-        // Free the surface after creating the texture
-        SDL_FreeSurface(displaySurface);
-        // Render the guessed number
-        SDL_RenderCopy(renderer, displayTexture, NULL, &displayRect);
+        drawAtlasText(&textAtlas, usernameText, 20, 40, color);
+
+        // Create and render the formatted guessed number; a long one shows
+        // the window starting at the digit the player types next
+        char digitsText[DIGIT_WINDOW + 8];
+        char displayText[DIGIT_WINDOW + 20];
+        formatDigitWindow(&session->formatted, number_length, session->digitCount, digitsText, sizeof(digitsText));
+        snprintf(displayText, sizeof(displayText), "Guess: %s", digitsText);
+        drawAtlasText(&textAtlas, displayText, 20, 100, color);
         // Render the level text
-        SDL_RenderCopy(renderer, levelTexture, NULL, &levelRect);
+        drawAtlasText(&textAtlas, levelText, 20, 10, color);
 
-        // Create and render the input display text
-        char inputText[number_length + 20];
-        if (DigitCount == number_length)
+        // Create and render the input display text, ending at the last digit typed
+        char inputText[DIGIT_WINDOW + 20];
+        if (session->levelSolved)
         {
             snprintf(inputText, sizeof(inputText), "Input: %s", initialDisplay);
         }
         else
         {
-            snprintf(inputText, sizeof(inputText), "Input: %s", guessed);
+            formatDigitWindow(&session->guessed, session->digitCount, session->digitCount - DIGIT_WINDOW, digitsText, sizeof(digitsText));
+            snprintf(inputText, sizeof(inputText), "Input: %s", digitsText);
         }
-
-        SDL_Surface *inputSurface = TTF_RenderText_Solid(font, inputText, color);
-        SDL_Texture *inputTexture = SDL_CreateTextureFromSurface(renderer, inputSurface);
-        SDL_Rect inputRect = {20, 140, inputSurface->w, inputSurface->h};
-        // Free the surface after creating the texture
-        SDL_FreeSurface(inputSurface);
         // Render the input display
-        SDL_RenderCopy(renderer, inputTexture, NULL, &inputRect);
-
-        // Calculate and render the elapsed time
-        time_t currentTime = time(NULL);
-        int elapsedTime = (int)difftime(currentTime, startTime);
+        drawAtlasText(&textAtlas, inputText, 20, 140, color);
 
-        char timeText[50];
-        snprintf(timeText, sizeof(timeText), "Time: %d s", elapsedTime);
-        SDL_Surface *timeSurface = TTF_RenderText_Solid(font, timeText, color);
-        SDL_Texture *timeTexture = SDL_CreateTextureFromSurface(renderer, timeSurface);
-        SDL_Rect timeRect = {WINDOW_WIDTH - timeSurface->w - 20, 10, timeSurface->w, timeSurface->h};
+        // A number too long to show whole gets a count of the digits typed so far
+        if (number_length > DIGIT_WINDOW)
+        {
+            char typedText[32], progressText[100];
+            formatThousands((uint64_t)session->digitCount, typedText, sizeof(typedText));
+            snprintf(progressText, sizeof(progressText), "Digits: %s of %s (Ctrl+V to paste)", typedText, lengthText);
+            drawAtlasText(&textAtlas, progressText, 20, 210, color);
+        }
 
-        // Free the surface after creating the texture
-        SDL_FreeSurface(timeSurface);
+        // Bulls-and-cows scoring also tells how many digits of the last guess are misplaced
+        if (session->bullsAndCows && session->attempts > 0)
+        {
+            char inPlaceText[32], misplacedText[32], scoreText[100];
+            formatThousands((uint64_t)session->lastInPlace, inPlaceText, sizeof(inPlaceText));
+            formatThousands((uint64_t)session->lastMisplaced, misplacedText, sizeof(misplacedText));
+            snprintf(scoreText, sizeof(scoreText), "In place: %s  Misplaced: %s", inPlaceText, misplacedText);
+            drawAtlasText(&textAtlas, scoreText, 20, 240, color);
+        }
 
-        // Render the time
-        SDL_RenderCopy(renderer, timeTexture, NULL, &timeRect);
+        // Render the time, aligned to the right edge
+        drawAtlasText(&textAtlas, timeText, WINDOW_WIDTH - measureAtlasText(&textAtlas, timeText) - 20, 10, color);
 
         // Render the result message if it exists
-        if (messageTexture)
+        if (messageText)
         {
-            SDL_RenderCopy(renderer, messageTexture, NULL, &messageRect);
+            drawAtlasText(&textAtlas, messageText, 20, 170, color);
         }
 
-        // Update the screen with the rendered content
+        // Draw all queued text and update the screen with the rendered content
+        flushTextAtlas(&textAtlas, renderer);
         SDL_RenderPresent(renderer);
-
-        // Clean up textures
-        SDL_DestroyTexture(displayTexture);
-        SDL_DestroyTexture(inputTexture);
-        // Add a small delay to control the loop speed
-        SDL_Delay(10);
+        clearRedraw(&scheduler);
     }
 
-    // Clean up message and username textures at the end of the loop
-    SDL_DestroyTexture(messageTexture);
-    SDL_DestroyTexture(usernameTexture);
-
-    // Calculate the time taken for this game session
-    time_t endTime = time(NULL);
-    timeTaken = (int)difftime(endTime, startTime);
+    // Calculate the time taken for this game session on the same clock as the on-screen time
+    timeTaken = (int)((SDL_GetTicks64() - startTicks) / 1000);
 }
 
-// Function to read high scores from a file
-void readHighScores(Score scores[], int *scoreCount)
+// Function to read up to maxScores of the top high scores from the leaderboard, best first
+void readHighScores(Score scores[], int maxScores, int *scoreCount)
 {
-    FILE *file = fopen("highscore.txt", "r");
-    if (file == NULL)
+    if (useServer)
     {
-        *scoreCount = 0;
+        LeaderboardRow rows[MAX_SCORES];
+        *scoreCount = clientTopScores(&leaderboardClient, rows, maxScores < MAX_SCORES ? maxScores : MAX_SCORES);
+        if (*scoreCount < 0)
+        {
+            *scoreCount = 0;
+        }
+        for (int i = 0; i < *scoreCount; i++)
+        {
+            strncpy(scores[i].username, rows[i].username, sizeof(scores[i].username) - 1);
+            scores[i].username[sizeof(scores[i].username) - 1] = '\0';
+            scores[i].time = rows[i].time;
+            scores[i].successRatio = rows[i].successRatio;
+        }
         return;
     }
 
-    *scoreCount = 0;
-    while (*scoreCount < MAX_SCORES && fscanf(file, "%s %d %lf", scores[*scoreCount].username, &scores[*scoreCount].time, &scores[*scoreCount].successRatio) == 3)
+    // The top list is shared by every game instance on this machine and read without locking
+    SharedScore top[SHARED_TOP_MAX];
+    *scoreCount = readCachedTopScores(top, maxScores < SHARED_TOP_MAX ? maxScores : SHARED_TOP_MAX);
+    for (int i = 0; i < *scoreCount; i++)
     {
-        (*scoreCount)++;
+        strncpy(scores[i].username, top[i].username, sizeof(scores[i].username) - 1);
+        scores[i].username[sizeof(scores[i].username) - 1] = '\0';
+        scores[i].time = top[i].time;
+        scores[i].successRatio = top[i].successRatio;
     }
-
-    fclose(file);
 }
 
-// Function to save high scores to a file
+// Function to save high scores to the leaderboard, keeping each player's better run
 void saveHighScores(Score scores[], int count)
 {
-    Score existingScores[MAX_SCORES * 10]; // Allow space for many scores
-    int existingCount = 0;
-
-    // Read existing high scores
-    readHighScores(existingScores, &existingCount);
-
-    // Add the new scores to the existing scores list
+    // Runs that improve show up in memory at once; writing them to disk happens off this thread
     for (int i = 0; i < count; i++)
     {
-        bool updated = false;
-        for (int j = 0; j < existingCount; j++)
+        if (useServer)
         {
-            if (strcmp(existingScores[j].username, scores[i].username) == 0)
+            bool improved;
+            if (!clientSubmitScore(&leaderboardClient, scores[i].username, scores[i].time, scores[i].successRatio, &improved))
             {
-                if (scores[i].successRatio > existingScores[j].successRatio)
-                {
-                    existingScores[j] = scores[i]; // Replace with the better run
-                }
-                updated = true;
-                break;
+                printf("Score could not be sent to the leaderboard server!\n");
             }
+            continue;
         }
-        if (!updated && existingCount < MAX_SCORES * 10)
-        {
-            existingScores[existingCount++] = scores[i]; // Add new entry if not found
-        }
+        submitCachedScore(scores[i].username, scores[i].time, scores[i].successRatio);
     }
+}
 
-    // Sort all scores in descending order
-    qsort(existingScores, existingCount, sizeof(Score), compareScores);
+// Function to get a player's rank among all players on the leaderboard
+bool readPlayerRank(const char *username, uint64_t *rank, uint64_t *total)
+{
+    if (useServer)
+    {
+        return clientPlayerRank(&leaderboardClient, username, rank, total);
+    }
 
-    // Save all scores back to the file
-    FILE *file = fopen("highscore.txt", "w");
-    if (file != NULL)
+    Leaderboard *leaderboard = cachedLeaderboard();
+    if (leaderboard == NULL)
     {
-        for (int i = 0; i < existingCount; i++)
-        {
-            fprintf(file, "%s\t%d\t%.2f\n", existingScores[i].username, existingScores[i].time, existingScores[i].successRatio);
-        }
-        fclose(file);
+        return false;
     }
+    *total = leaderboardSize(leaderboard);
+    return leaderboardRank(leaderboard, username, rank);
 }
 
-// Function to compare scores for sorting
-int compareScores(const void *a, const void *b)
+// Function to write the digits of a packed number that fit on screen: all of
+// them if there are at most DIGIT_WINDOW, otherwise DIGIT_WINDOW of them from
+// position first on, with "..." where digits are left out; only these few
+// digits are ever turned into text
+void formatDigitWindow(const DigitBuffer *digits, int length, int first, char *text, int size)
 {
-    const Score *scoreA = (const Score *)a;
-    const Score *scoreB = (const Score *)b;
+    char window[DIGIT_WINDOW + 1];
+    if (length <= DIGIT_WINDOW)
+    {
+        unpackDigits(digits, 0, length, window);
+        snprintf(text, size, "%s", window);
+        return;
+    }
+    first = first > length - DIGIT_WINDOW ? length - DIGIT_WINDOW : first;
+    first = first < 0 ? 0 : first;
+    unpackDigits(digits, first, DIGIT_WINDOW, window);
+    snprintf(text, size, "%s%s%s", first > 0 ? "..." : "", window, first + DIGIT_WINDOW < length ? "..." : "");
+}
 
-    // Sort in descending order based on successRatio
-    if (scoreA->successRatio < scoreB->successRatio)
-        return 1;
-    else if (scoreA->successRatio > scoreB->successRatio)
-        return -1;
-    else
-        return 0;
+// Function to write a number with thousands separators (12,345)
+void formatThousands(uint64_t value, char *text, int size)
+{
+    char digits[32];
+    int length = snprintf(digits, sizeof(digits), "%llu", (unsigned long long)value);
+    int out = 0;
+    for (int i = 0; i < length && out < size - 1; i++)
+    {
+        if (i > 0 && (length - i) % 3 == 0 && out < size - 2)
+        {
+            text[out++] = ',';
+        }
+        text[out++] = digits[i];
+    }
+    text[out] = '\0';
 }
+
 // Function to show high scores
-void showHighScores(int *attempts, int *correctGuesses)
+void showHighScores(GameSession *session, const char *username)
 {
-    Score scores[MAX_SCORES * 10];
+    Score scores[MAX_SCORES];
     int scoreCount = 0;
-    readHighScores(scores, &scoreCount);
-
-    // Sort the scores in descending order by success ratio
-    qsort(scores, scoreCount, sizeof(Score), compareScores);
+    readHighScores(scores, MAX_SCORES, &scoreCount);
 
     // Show only the top 5 scores
     char highScoreText[] = "Leaderboard";
     color = {237, 170, 125};
-    SDL_Surface *highScoreSurface = TTF_RenderText_Solid(font, highScoreText, color);
-    SDL_Texture *highScoreTexture = SDL_CreateTextureFromSurface(renderer, highScoreSurface);
-    SDL_Rect highScoreRect = {250, 20, highScoreSurface->w, highScoreSurface->h};
-    SDL_RenderCopy(renderer, highScoreTexture, NULL, &highScoreRect);
+    drawAtlasText(&textAtlas, highScoreText, 250, 20, color);
 
     char divideText[] = "------------------------------------------------------------------------------";
-    color = {237, 170, 125};
-    highScoreSurface = TTF_RenderText_Solid(font, divideText, color);
-    highScoreTexture = SDL_CreateTextureFromSurface(renderer, highScoreSurface);
-    highScoreRect = {0, 40, highScoreSurface->w, highScoreSurface->h};
-    SDL_FreeSurface(highScoreSurface);
-    SDL_RenderCopy(renderer, highScoreTexture, NULL, &highScoreRect);
-    SDL_DestroyTexture(highScoreTexture);
+    drawAtlasText(&textAtlas, divideText, 0, 40, color);
 
     // Start position for the first score line
     int yOffset = 100;
@@ -793,30 +806,29 @@ void showHighScores(int *attempts, int *correctGuesses)
         char scoreLine[100];
         snprintf(scoreLine, sizeof(scoreLine), "%d. %s - Time: %d - Success: %.2f%%",
                  i + 1, scores[i].username, scores[i].time, scores[i].successRatio);
-
-        SDL_Surface *scoreSurface = TTF_RenderText_Solid(font, scoreLine, color);
-        SDL_Texture *scoreTexture = SDL_CreateTextureFromSurface(renderer, scoreSurface);
-        SDL_Rect scoreRect = {20, yOffset, scoreSurface->w, scoreSurface->h};
-        SDL_FreeSurface(scoreSurface);
-
-        SDL_RenderCopy(renderer, scoreTexture, NULL, &scoreRect);
-        SDL_DestroyTexture(scoreTexture);
+        drawAtlasText(&textAtlas, scoreLine, 20, yOffset, color);
 
         // Move down for the next score line, with a small gap
-        yOffset += scoreRect.h + 10;
+        yOffset += textAtlas.lineHeight + 10;
+    }
+
+    // Show where the player stands among everyone, not just the top 5
+    uint64_t rank, total;
+    if (readPlayerRank(username, &rank, &total))
+    {
+        char rankText[32], totalText[32], rankLine[120];
+        formatThousands(rank, rankText, sizeof(rankText));
+        formatThousands(total, totalText, sizeof(totalText));
+        snprintf(rankLine, sizeof(rankLine), "You are #%s of %s (better than %.2f%% of players)", rankText, totalText, rankPercentile(rank, total));
+        drawAtlasText(&textAtlas, rankLine, 20, 300, color);
     }
 
     if (gameFinished)
     {
         color = {172, 153, 193};
-        SDL_Surface *messageSurface = TTF_RenderText_Solid(font, "Press Enter to play again with the same username", color);
-        SDL_Texture *messageTexture = SDL_CreateTextureFromSurface(renderer, messageSurface);
-        SDL_Rect messageRect = {20, 300, messageSurface->w, messageSurface->h};
-        SDL_FreeSurface(messageSurface);
-
-        SDL_RenderCopy(renderer, messageTexture, NULL, &messageRect);
+        drawAtlasText(&textAtlas, "Press Enter to play again with the same username", 20, 340, color);
+        flushTextAtlas(&textAtlas, renderer);
         SDL_RenderPresent(renderer);
-        SDL_DestroyTexture(messageTexture);
 
         while (SDL_WaitEvent(&e))
         {
@@ -829,10 +841,9 @@ void showHighScores(int *attempts, int *correctGuesses)
             else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_RETURN)
             {
                 // Reset timer to 0 if user wants to play again
-                startTime = time(NULL);
-                // Reset ratio if decided to play again with the same username
-                *attempts = 0;
-                *correctGuesses = 0;
+                startTicks = SDL_GetTicks64();
+                // Reset ratio and level if decided to play again with the same username
+                restartSession(session);
                 break;
             }
         }
@@ -0,0 +1,382 @@
+// Headless game core
+// Nothing in this file touches SDL or global state; every function works on
+// the session it is given, so any number of sessions can run side by side
+
+#include "game_core.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Function to grow the digit buffers to hold length digits each; the old
+// digits are not kept (a new level rewrites them), so nothing is copied, and
+// if any allocation fails the session keeps its old buffers
+static bool growBuffers(GameSession *session, int length)
+{
+    DigitBuffer magicNumber = {NULL, 0};
+    DigitBuffer guessed = {NULL, 0};
+    DigitBuffer formatted = {NULL, 0};
+    DigitBuffer liveFormatted = {NULL, 0};
+    if (!reserveDigitBuffer(&magicNumber, length) || !reserveDigitBuffer(&guessed, length) || !reserveDigitBuffer(&formatted, length) || !reserveDigitBuffer(&liveFormatted, length))
+    {
+        freeDigitBuffer(&magicNumber);
+        freeDigitBuffer(&guessed);
+        freeDigitBuffer(&formatted);
+        freeDigitBuffer(&liveFormatted);
+        return false;
+    }
+    freeDigitBuffer(&session->magicNumber);
+    freeDigitBuffer(&session->guessed);
+    freeDigitBuffer(&session->formatted);
+    freeDigitBuffer(&session->liveFormatted);
+    session->magicNumber = magicNumber;
+    session->guessed = guessed;
+    session->formatted = formatted;
+    session->liveFormatted = liveFormatted;
+    return true;
+}
+
+// Function to add how often each digit occurs in a run of a packed number to
+// counts, with the histogram kernel once the run reaches a word boundary
+static void addDigitCounts(const DigitBuffer *digits, int first, int count, int counts[DIGIT_VALUES])
+{
+    size_t added[DIGIT_VALUES] = {0};
+    int end = first + count;
+    for (; first < end && first % DIGITS_PER_WORD != 0; first++)
+    {
+        added[getDigit(digits, first)]++;
+    }
+    if (first < end)
+    {
+        countDigitWords(digits->words + first / DIGITS_PER_WORD, (size_t)(end - first), added);
+    }
+    for (int d = 0; d < DIGIT_VALUES; d++)
+    {
+        counts[d] += (int)added[d];
+    }
+}
+
+// Function to count the digits the guess shares with the magic number, in place or not
+static void countCommonDigits(GameSession *session)
+{
+    session->commonCount = 0;
+    for (int d = 0; d < DIGIT_VALUES; d++)
+    {
+        session->commonCount += session->guessCounts[d] < session->magicCounts[d] ? session->guessCounts[d] : session->magicCounts[d];
+    }
+}
+
+// Function to check one typed digit against the magic number
+static void trackDigit(GameSession *session, int index)
+{
+    int digit = getDigit(&session->guessed, index);
+    bool match = digit == getDigit(&session->magicNumber, index);
+    setDigit(&session->liveFormatted, index, match ? digit : DIGIT_BLANK);
+    session->matchCount += match;
+}
+
+// Function to check a run of typed digits, a word at a time once the run
+// reaches a word boundary; positions past the run in its last word may be
+// written, which is harmless since they are past digitCount
+static void trackDigits(GameSession *session, int first, int count)
+{
+    if (session->bullsAndCows)
+    {
+        addDigitCounts(&session->guessed, first, count, session->guessCounts);
+        countCommonDigits(session);
+    }
+
+    int end = first + count;
+    for (; first < end && first % DIGITS_PER_WORD != 0; first++)
+    {
+        trackDigit(session, first);
+    }
+    if (first < end)
+    {
+        int word = first / DIGITS_PER_WORD;
+        DigitMatch match = compareDigitWords(session->magicNumber.words + word, session->guessed.words + word, session->liveFormatted.words + word, (size_t)(end - first));
+        session->matchCount += (int)match.matches;
+    }
+}
+
+// Function to count the digits of the magic number and of the guess so far
+// for bulls-and-cows scoring; nothing is counted when it is off
+static void countLevelDigits(GameSession *session)
+{
+    memset(session->magicCounts, 0, sizeof(session->magicCounts));
+    memset(session->guessCounts, 0, sizeof(session->guessCounts));
+    session->commonCount = 0;
+    if (session->bullsAndCows)
+    {
+        addDigitCounts(&session->magicNumber, 0, session->numberLength, session->magicCounts);
+        addDigitCounts(&session->guessed, 0, session->digitCount, session->guessCounts);
+        countCommonDigits(session);
+    }
+}
+
+// Function to size the digit buffers and pick a new magic number for the current level
+static bool startLevel(GameSession *session)
+{
+    int length = session->numberLength;
+    if (length > session->magicNumber.capacity && !growBuffers(session, length))
+    {
+        return false;
+    }
+
+    randomDigitBuffer(&session->rng, &session->magicNumber, length);
+    fillDigitBuffer(&session->formatted, length, DIGIT_BLANK);
+    session->digitCount = 0;
+    session->matchCount = 0;
+    session->lastInPlace = 0;
+    session->lastMisplaced = 0;
+    countLevelDigits(session);
+    session->levelSolved = false;
+    return true;
+}
+
+// Function to create a session at the first level; the same seed gives the same magic numbers
+GameSession *newSession(uint64_t seed)
+{
+    GameSession *session = (GameSession *)calloc(1, sizeof(GameSession));
+    if (session == NULL)
+    {
+        return NULL;
+    }
+
+    if (!initSession(session, seed))
+    {
+        freeSession(session);
+        return NULL;
+    }
+    return session;
+}
+
+// Function to start a session at the first level in place; digit buffers it
+// already has are kept if they are big enough, so pooled sessions never allocate
+bool initSession(GameSession *session, uint64_t seed)
+{
+    seedRng(&session->rng, seed);
+    session->level = 1;
+    session->numberLength = DEFAULT_NUM_LENGTH;
+    session->attempts = 0;
+    session->correctGuesses = 0;
+    session->finished = false;
+    return startLevel(session);
+}
+
+// Function to release a session and its digit buffers
+void freeSession(GameSession *session)
+{
+    if (session == NULL)
+    {
+        return;
+    }
+    freeDigitBuffer(&session->magicNumber);
+    freeDigitBuffer(&session->guessed);
+    freeDigitBuffer(&session->formatted);
+    freeDigitBuffer(&session->liveFormatted);
+    free(session);
+}
+
+// Function to start a new run from the first level, keeping the session's buffers
+void restartSession(GameSession *session)
+{
+    session->level = 1;
+    session->numberLength = DEFAULT_NUM_LENGTH;
+    session->attempts = 0;
+    session->correctGuesses = 0;
+    session->finished = false;
+    startLevel(session);
+}
+
+// Function to switch the session between the three levels and marathon levels;
+// takes effect from the next level. Pooled sessions must stay at three levels,
+// since their digit buffers cannot grow
+void setMarathon(GameSession *session, bool marathon)
+{
+    session->marathon = marathon;
+}
+
+// Function to switch bulls-and-cows scoring on or off; it takes effect at once,
+// so the current level's digits are counted when it is switched on
+void setBullsAndCows(GameSession *session, bool bullsAndCows)
+{
+    session->bullsAndCows = bullsAndCows;
+    countLevelDigits(session);
+}
+
+// Function to append a digit (0-9) to the current guess
+bool submitDigit(GameSession *session, int digit)
+{
+    if (session->finished || session->levelSolved || digit < 0 || digit > 9 || session->digitCount >= session->numberLength)
+    {
+        return false;
+    }
+    setDigit(&session->guessed, session->digitCount, digit);
+    trackDigit(session, session->digitCount++);
+
+    // The digit is shared with the magic number if it has more of them than the guess had
+    if (session->bullsAndCows && session->guessCounts[digit]++ < session->magicCounts[digit])
+    {
+        session->commonCount++;
+    }
+    return true;
+}
+
+// Function to append the digits of text to the current guess, skipping
+// anything else (a pasted number may have spaces or line breaks); returns
+// how many digits were taken before the guess was full
+int submitDigits(GameSession *session, const char *text)
+{
+    if (session->finished || session->levelSolved)
+    {
+        return 0;
+    }
+    // Pack whole runs of digits at once, since a marathon paste is millions of them
+    int taken = 0;
+    const char *c = text;
+    while (*c != '\0' && session->digitCount < session->numberLength)
+    {
+        size_t run = strspn(c, "0123456789");
+        size_t room = (size_t)(session->numberLength - session->digitCount);
+        size_t copied = run < room ? run : room;
+        packDigits(&session->guessed, session->digitCount, c, (int)copied);
+        trackDigits(session, session->digitCount, (int)copied);
+        session->digitCount += (int)copied;
+        taken += (int)copied;
+        c += run;
+        if (run == 0)
+        {
+            c++;
+        }
+    }
+    return taken;
+}
+
+// Function to remove the last digit of the current guess
+bool removeDigit(GameSession *session)
+{
+    if (session->levelSolved || session->digitCount == 0)
+    {
+        return false;
+    }
+    // A matching digit is the only kind liveFormatted keeps
+    if (getDigit(&session->liveFormatted, --session->digitCount) != DIGIT_BLANK)
+    {
+        session->matchCount--;
+    }
+
+    // The digit was shared if the guess is left with fewer of them than the magic number
+    int digit = getDigit(&session->guessed, session->digitCount);
+    if (session->bullsAndCows && --session->guessCounts[digit] < session->magicCounts[digit])
+    {
+        session->commonCount--;
+    }
+    return true;
+}
+
+// Function to check the current guess against the magic number once all
+// digits are in; the digits were checked as they were typed, so this takes
+// the same time for any length
+GuessResult submitGuess(GameSession *session)
+{
+    if (session->finished || session->levelSolved || session->digitCount < session->numberLength)
+    {
+        return GUESS_INCOMPLETE;
+    }
+
+    // Count the attempt; a guess with any digit in the right place is a correct
+    // guess, and with bulls-and-cows scoring so is one with a misplaced digit
+    session->attempts++;
+    session->lastInPlace = session->matchCount;
+    session->lastMisplaced = session->bullsAndCows ? session->commonCount - session->matchCount : 0;
+    if (session->lastInPlace > 0 || session->lastMisplaced > 0)
+    {
+        session->correctGuesses++;
+    }
+
+    // The live feedback becomes the shown one by swapping buffers, not copying them
+    DigitBuffer formatted = session->formatted;
+    session->formatted = session->liveFormatted;
+    session->liveFormatted = formatted;
+
+    if (session->matchCount == session->numberLength)
+    {
+        session->levelSolved = true;
+        return GUESS_CORRECT;
+    }
+
+    // Clear the guess so the player can try again; the old digits are simply typed over
+    session->digitCount = 0;
+    session->matchCount = 0;
+    memset(session->guessCounts, 0, sizeof(session->guessCounts));
+    session->commonCount = 0;
+    return GUESS_INCORRECT;
+}
+
+// Function to move to the next level, returning false if the last level was solved
+bool advanceLevel(GameSession *session)
+{
+    if (!session->levelSolved || onLastLevel(session))
+    {
+        return false;
+    }
+    int length = session->numberLength;
+    session->level++;
+    if (session->marathon)
+    {
+        long long grown = (long long)length * MARATHON_GROWTH;
+        session->numberLength = grown < MARATHON_MAX_DIGITS ? (int)grown : MARATHON_MAX_DIGITS;
+    }
+    else
+    {
+        session->numberLength++;
+    }
+
+    // Without memory for the longer number the session stays on the level it solved
+    if (!startLevel(session))
+    {
+        session->level--;
+        session->numberLength = length;
+        return false;
+    }
+    return true;
+}
+
+// Function to check whether solving the current level ends the run
+bool onLastLevel(const GameSession *session)
+{
+    if (session->marathon)
+    {
+        return session->numberLength >= MARATHON_MAX_DIGITS;
+    }
+    return session->level >= MAX_GAME_LEVEL;
+}
+
+// Function to end the run and get its success ratio
+double finishSession(GameSession *session)
+{
+    session->finished = true;
+    return sessionSuccessRatio(session);
+}
+
+// Function to calculate the success ratio: correct guesses / attempts * 100
+double sessionSuccessRatio(const GameSession *session)
+{
+    if (session->attempts > 0)
+    {
+        return (double)session->correctGuesses / session->attempts * 100.0;
+    }
+    return 0.0;
+}
+
+// Function to generate a random magic number from the session's engine
+void randomNumber(DigitRng *rng, char *magicNumber, int number_length)
+{
+    randomDigits(rng, magicNumber, number_length);
+    magicNumber[number_length] = '\0';
+}
+
+// Function to format the guessed number
+void formatGuess(const char *magicNumber, const char *guessed, char *formatted, int number_length)
+{
+    compareDigits(magicNumber, guessed, formatted, number_length);
+}
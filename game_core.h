@@ -0,0 +1,80 @@
+// Headless game core
+// All of the guessing game's rules live here, behind an explicit session
+// structure, so the SDL front end, servers and simulations can share them
+
+#ifndef GAME_CORE_H
+#define GAME_CORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "prng.h"
+#include "digit_compare.h"
+#include "digit_buffer.h"
+
+// Define constants
+#define MAX_GAME_LEVEL 3
+#define DEFAULT_NUM_LENGTH 4
+
+// Marathon levels double the number's length up to this many digits, then the run ends
+#define MARATHON_GROWTH 2
+#define MARATHON_MAX_DIGITS 10000000
+
+// Result of submitting a guess
+typedef enum
+{
+    GUESS_INCOMPLETE,
+    GUESS_INCORRECT,
+    GUESS_CORRECT
+} GuessResult;
+
+// Structure to store the state of one player's run through the levels; the
+// numbers are packed, and only the first digitCount positions of guessed and
+// liveFormatted mean anything. Every digit typed is checked at once, so
+// liveFormatted and matchCount always describe the guess so far
+typedef struct
+{
+    int level;
+    int numberLength;
+    DigitBuffer magicNumber;
+    DigitBuffer guessed;
+    DigitBuffer formatted;
+    DigitBuffer liveFormatted;
+    int digitCount;
+    int matchCount;
+    int attempts;
+    int correctGuesses;
+    bool levelSolved;
+    bool finished;
+    bool marathon;
+
+    // Bulls-and-cows scoring: how often each digit occurs in the magic number
+    // and in the guess so far, and how many digits the two share wherever they
+    // are; the last guess's digits in place and misplaced are kept to be shown
+    bool bullsAndCows;
+    int magicCounts[DIGIT_VALUES];
+    int guessCounts[DIGIT_VALUES];
+    int commonCount;
+    int lastInPlace;
+    int lastMisplaced;
+    DigitRng rng;
+} GameSession;
+
+// Function prototypes
+GameSession *newSession(uint64_t seed);
+bool initSession(GameSession *session, uint64_t seed);
+void freeSession(GameSession *session);
+void restartSession(GameSession *session);
+void setMarathon(GameSession *session, bool marathon);
+void setBullsAndCows(GameSession *session, bool bullsAndCows);
+bool submitDigit(GameSession *session, int digit);
+int submitDigits(GameSession *session, const char *text);
+bool removeDigit(GameSession *session);
+GuessResult submitGuess(GameSession *session);
+bool advanceLevel(GameSession *session);
+bool onLastLevel(const GameSession *session);
+double finishSession(GameSession *session);
+double sessionSuccessRatio(const GameSession *session);
+void randomNumber(DigitRng *rng, char *magicNumber, int number_length);
+void formatGuess(const char *magicNumber, const char *guessed, char *formatted, int number_length);
+
+#endif
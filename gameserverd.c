@@ -0,0 +1,325 @@
+// Headless game server
+// Hosts guessing sessions for clients that speak a line protocol over a Unix
+// domain socket or a localhost TCP port. Each connection plays one session
+// from a pool, with the same levels, feedback and scoring as the SDL game.
+// Every worker process runs one epoll loop over the shared listening sockets,
+// so sessions scale with --workers up to one worker per core. Linux only
+// Build with "make gameserverd" and run ./gameserverd [--unix PATH] [--tcp PORT] [--sessions N] [--workers N]
+//
+// Requests and replies are one line each:
+//   NEW [SEED]     -> LEVEL <level> <digits>
+//   GUESS <digits> -> MISS <feedback> <attempts> <correct>
+//                     HIT <feedback> <attempts> <correct> LEVEL <level> <digits>
+//                     HIT <feedback> <attempts> <correct> DONE <success ratio>
+//   QUIT           -> BYE, then the server closes the connection
+// A request that cannot be played gets ERR <reason>
+
+#include "event_server.h"
+#include "session_pool.h"
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define GAMESERVER_DEFAULT_PORT 7788
+#define GAMESERVER_DEFAULT_SOCKET "gameserver.sock"
+#define GAMESERVER_DEFAULT_SESSIONS 10000
+#define GAMESERVER_MAX_WORKERS 64
+#define GAMESERVER_INPUT_SIZE 4096
+#define GAMESERVER_INITIAL_OUTPUT 4096
+#define GAMESERVER_MAX_REPLY 96
+
+// Connections one worker takes per wakeup, so a burst of them is spread over the workers
+#define GAMESERVER_ACCEPT_BATCH 16
+
+// Structure to store one worker's state; each connection's session is its context
+typedef struct
+{
+    SessionPool pool;
+    uint64_t games;
+    uint64_t guesses;
+    int active;
+    int peakActive;
+} Server;
+
+// Function to return a closing connection's session to the pool
+static void releaseConnection(void *owner, EventConnection *connection)
+{
+    Server *server = (Server *)owner;
+    if (connection->context != NULL)
+    {
+        releaseSession(&server->pool, (GameSession *)connection->context);
+        server->active--;
+    }
+}
+
+// Function to queue one reply line
+static bool queueLine(EventConnection *connection, const char *format, ...)
+{
+    if (!reserveOutput(connection, GAMESERVER_MAX_REPLY))
+    {
+        return false;
+    }
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(connection->output + connection->outputUsed, GAMESERVER_MAX_REPLY, format, args);
+    va_end(args);
+    if (length < 0 || length >= GAMESERVER_MAX_REPLY)
+    {
+        return false;
+    }
+    connection->outputUsed += (size_t)length;
+    return true;
+}
+
+// Function to play one guess of the connection's session
+static bool playGuess(Server *server, EventConnection *connection, const char *digits)
+{
+    GameSession *session = (GameSession *)connection->context;
+    if (session == NULL)
+    {
+        return queueLine(connection, "ERR no game, send NEW\n");
+    }
+    if (session->finished)
+    {
+        return queueLine(connection, "ERR game over, send NEW\n");
+    }
+    if ((int)strlen(digits) != session->numberLength)
+    {
+        return queueLine(connection, "ERR guess needs %d digits\n", session->numberLength);
+    }
+
+    for (int i = 0; digits[i] != '\0'; i++)
+    {
+        if (digits[i] < '0' || digits[i] > '9')
+        {
+            return queueLine(connection, "ERR guess must be digits\n");
+        }
+    }
+
+    // Enter the guess digit by digit, the way the keyboard does
+    while (removeDigit(session))
+    {
+    }
+    for (int i = 0; digits[i] != '\0'; i++)
+    {
+        submitDigit(session, digits[i] - '0');
+    }
+    server->guesses++;
+
+    // The feedback is unpacked before the next level replaces the digit buffers
+    GuessResult result = submitGuess(session);
+    char feedback[POOL_DIGIT_BUFFER];
+    unpackDigits(&session->formatted, 0, session->numberLength, feedback);
+    if (result == GUESS_INCORRECT)
+    {
+        return queueLine(connection, "MISS %s %d %d\n", feedback, session->attempts, session->correctGuesses);
+    }
+
+    if (advanceLevel(session))
+    {
+        return queueLine(connection, "HIT %s %d %d LEVEL %d %d\n", feedback, session->attempts, session->correctGuesses, session->level, session->numberLength);
+    }
+    double ratio = finishSession(session);
+    return queueLine(connection, "HIT %s %d %d DONE %.2f\n", feedback, session->attempts, session->correctGuesses, ratio);
+}
+
+// Function to answer one request line; false if the connection has to be closed
+static bool handleLine(Server *server, EventConnection *connection, char *line)
+{
+    char *command = strtok(line, " \t\r");
+    char *argument = command ? strtok(NULL, " \t\r") : NULL;
+    if (command == NULL)
+    {
+        return true;
+    }
+
+    if (strcmp(command, "NEW") == 0)
+    {
+        uint64_t seed = argument ? strtoull(argument, NULL, 10) : ((uint64_t)time(NULL) << 32) ^ (server->games * 0x9e3779b97f4a7c15ULL) ^ (uint64_t)getpid();
+        GameSession *session = (GameSession *)connection->context;
+        if (session == NULL)
+        {
+            session = acquireSession(&server->pool, seed);
+            if (session == NULL)
+            {
+                return queueLine(connection, "ERR server full\n");
+            }
+            server->active++;
+            server->peakActive = server->active > server->peakActive ? server->active : server->peakActive;
+            connection->context = session;
+        }
+        else
+        {
+            initSession(session, seed);
+        }
+        server->games++;
+        return queueLine(connection, "LEVEL %d %d\n", session->level, session->numberLength);
+    }
+    if (strcmp(command, "GUESS") == 0 && argument != NULL)
+    {
+        return playGuess(server, connection, argument);
+    }
+    if (strcmp(command, "QUIT") == 0)
+    {
+        connection->closing = true;
+        return queueLine(connection, "BYE\n");
+    }
+    return queueLine(connection, "ERR unknown request\n");
+}
+
+// Function to answer every complete line in the input buffer; false if the connection has to be closed
+static bool handleInput(void *owner, EventConnection *connection)
+{
+    Server *server = (Server *)owner;
+    size_t used = 0;
+    while (!connection->closing)
+    {
+        char *end = (char *)memchr(connection->input + used, '\n', connection->inputUsed - used);
+        if (end == NULL)
+        {
+            break;
+        }
+        *end = '\0';
+        if (!handleLine(server, connection, connection->input + used))
+        {
+            return false;
+        }
+        used = (size_t)(end - connection->input) + 1;
+    }
+
+    // A full buffer without a newline is not a request this server understands
+    if (used == 0 && connection->inputUsed == GAMESERVER_INPUT_SIZE)
+    {
+        return false;
+    }
+    memmove(connection->input, connection->input + used, connection->inputUsed - used);
+    connection->inputUsed -= used;
+    return true;
+}
+
+// Function to run one worker's event loop until the server is stopped
+static int runWorker(EventServer *events, int sessions)
+{
+    Server server;
+    memset(&server, 0, sizeof(server));
+    if (!initSessionPool(&server.pool, sessions))
+    {
+        printf("Session pool could not be created!\n");
+        return 1;
+    }
+
+    // With several workers on one socket, EPOLLEXCLUSIVE wakes only one of them per connection
+    events->owner = &server;
+    if (!startEventLoop(events, EPOLLEXCLUSIVE))
+    {
+        freeSessionPool(&server.pool);
+        return 1;
+    }
+    runEventLoop(events);
+
+    // Client connections close with the process
+    printf("Game server worker %d: %llu connections, %llu games, %llu guesses, at most %d sessions at once\n", (int)getpid(), (unsigned long long)events->connections, (unsigned long long)server.games, (unsigned long long)server.guesses, server.peakActive);
+    closeEventLoop(events);
+    freeSessionPool(&server.pool);
+    return 0;
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+    const char *unixPath = NULL;
+    int port = 0;
+    int sessions = GAMESERVER_DEFAULT_SESSIONS;
+    int workers = 1;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--unix") == 0)
+        {
+            unixPath = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--tcp") == 0)
+        {
+            port = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--sessions") == 0)
+        {
+            sessions = atoi(argv[i + 1]) > 0 ? atoi(argv[i + 1]) : 1;
+        }
+        else if (strcmp(argv[i], "--workers") == 0)
+        {
+            workers = atoi(argv[i + 1]);
+            workers = workers < 1 ? 1 : workers > GAMESERVER_MAX_WORKERS ? GAMESERVER_MAX_WORKERS : workers;
+        }
+    }
+
+    // Without --unix or --tcp, listen on both defaults
+    if (unixPath == NULL && port == 0)
+    {
+        unixPath = GAMESERVER_DEFAULT_SOCKET;
+        port = GAMESERVER_DEFAULT_PORT;
+    }
+
+    EventHandlers handlers = {handleInput, releaseConnection, NULL, NULL, NULL};
+    EventServer events;
+    initEventServer(&events, GAMESERVER_INPUT_SIZE, GAMESERVER_INITIAL_OUTPUT, handlers, NULL);
+    events.acceptBatch = GAMESERVER_ACCEPT_BATCH;
+    if (!openListeners(&events, unixPath, port))
+    {
+        return 1;
+    }
+
+    catchStopSignals();
+    printf("Game server with %d worker(s) of %d sessions each\n", workers, sessions);
+    fflush(stdout);
+
+    // A single worker runs in this process; otherwise each one is a child that shares the listening sockets
+    int status = 0;
+    if (workers == 1)
+    {
+        status = runWorker(&events, sessions);
+    }
+    else
+    {
+        pid_t children[GAMESERVER_MAX_WORKERS];
+        int started = 0;
+        for (int i = 0; i < workers; i++)
+        {
+            pid_t child = fork();
+            if (child == 0)
+            {
+                exit(runWorker(&events, sessions));
+            }
+            if (child > 0)
+            {
+                children[started++] = child;
+            }
+        }
+
+        // The stop signals are blocked between the check and the wait, so one cannot slip in unnoticed;
+        // the workers are forked first so they keep receiving them
+        sigset_t stopSignals, oldMask;
+        sigemptyset(&stopSignals);
+        sigaddset(&stopSignals, SIGINT);
+        sigaddset(&stopSignals, SIGTERM);
+        sigprocmask(SIG_BLOCK, &stopSignals, &oldMask);
+        while (!stopRequested())
+        {
+            sigsuspend(&oldMask);
+        }
+        sigprocmask(SIG_SETMASK, &oldMask, NULL);
+        for (int i = 0; i < started; i++)
+        {
+            kill(children[i], SIGTERM);
+            waitpid(children[i], NULL, 0);
+        }
+    }
+
+    closeListeners(&events);
+    return status;
+}
@@ -0,0 +1,186 @@
+// Leaderboard engine
+// A player's key never goes down (the store keeps the better run), so once
+// a player drops out of the top-K list only an improvement can bring them
+// back, and the list stays exact by looking at each submission alone
+
+#include "leaderboard.h"
+#include <stdio.h>
+#include <string.h>
+
+// Function to open the score store, copy it into the score table and build the top-K list from the key column
+bool openLeaderboard(Leaderboard *leaderboard, const char *path, const char *legacyPath, int topSize)
+{
+    memset(leaderboard, 0, sizeof(*leaderboard));
+    if (!initTopScores(&leaderboard->top, topSize))
+    {
+        return false;
+    }
+    if (!openScoreStore(&leaderboard->store, path, legacyPath))
+    {
+        freeTopScores(&leaderboard->top);
+        return false;
+    }
+    if (!loadScoreTable(&leaderboard->table, &leaderboard->store))
+    {
+        printf("Score table could not be created!\n");
+        closeLeaderboard(leaderboard);
+        return false;
+    }
+    for (uint64_t row = 0; row < leaderboard->table.count; row++)
+    {
+        offerTopScore(&leaderboard->top, row, leaderboard->table.keys[row]);
+    }
+    return true;
+}
+
+// Function to close the store and free the score table, top-K list and rank index
+void closeLeaderboard(Leaderboard *leaderboard)
+{
+    closeScoreStore(&leaderboard->store);
+    freeScoreTable(&leaderboard->table);
+    freeRankIndex(&leaderboard->rank);
+    freeTopScores(&leaderboard->top);
+    memset(leaderboard, 0, sizeof(*leaderboard));
+}
+
+// Function to put a changed record in the score table, the top-K list and, once built, the rank index
+static void placeScore(Leaderboard *leaderboard, uint64_t slot)
+{
+    // A new player's slot is past the table's last row; copying every
+    // missing row keeps row and slot numbers equal however changes arrive
+    const ScoreRecord *record = storeRecord(&leaderboard->store, slot);
+    bool copied = slot < leaderboard->table.count ? setScoreRow(&leaderboard->table, slot, record) : loadScoreTable(&leaderboard->table, &leaderboard->store);
+    if (!copied)
+    {
+        // The run is saved; it shows up once the leaderboard is reopened
+        printf("Score table could not be updated!\n");
+        return;
+    }
+    uint64_t key = leaderboard->table.keys[slot];
+    offerTopScore(&leaderboard->top, slot, key);
+    if (leaderboard->rankReady)
+    {
+        updateRank(&leaderboard->rank, slot, key);
+    }
+}
+
+// Function to record a player's run and update the top-K list if it improved
+bool submitScore(Leaderboard *leaderboard, const char *username, int time, double successRatio)
+{
+    uint64_t slot;
+    if (!upsertScore(&leaderboard->store, username, time, successRatio, &slot))
+    {
+        return false;
+    }
+    placeScore(leaderboard, slot);
+    return true;
+}
+
+// Function to record a player's run in memory only; if it improved, entry
+// receives the journal entry that still has to be written with writeJournal()
+bool stageScore(Leaderboard *leaderboard, const char *username, int time, double successRatio, JournalEntry *entry)
+{
+    uint64_t slot;
+    if (!prepareScore(&leaderboard->store, username, time, successRatio, entry, &slot) || !applyScore(&leaderboard->store, entry, &slot))
+    {
+        return false;
+    }
+    placeScore(leaderboard, slot);
+    return true;
+}
+
+// Function to update the top-K list and rank index for a record another process improved
+static bool visitChanged(const ScoreRecord *record, uint64_t slot, void *context)
+{
+    (void)record;
+    placeScore((Leaderboard *)context, slot);
+    return true;
+}
+
+// Function to pick up runs other processes saved; false if they replaced
+// the snapshot, in which case the leaderboard has to be reopened
+bool refreshLeaderboard(Leaderboard *leaderboard)
+{
+    return refreshScoreStore(&leaderboard->store, visitChanged, leaderboard);
+}
+
+// Function to close and reopen the leaderboard from its files, keeping its path, top-K size and writers' lock
+bool reopenLeaderboard(Leaderboard *leaderboard)
+{
+    char path[SCORE_PATH_SIZE];
+    snprintf(path, sizeof(path), "%s", leaderboard->store.path);
+    int topSize = leaderboard->top.capacity;
+    uint32_t *writerLock = leaderboard->store.writerLock;
+    closeLeaderboard(leaderboard);
+    if (!openLeaderboard(leaderboard, path, NULL, topSize))
+    {
+        return false;
+    }
+    setScoreStoreWriterLock(&leaderboard->store, writerLock);
+    return true;
+}
+
+// Function to build the rank index the first time a rank is asked for; it
+// can also be called ahead of time so the first rank query is O(log n)
+bool prepareLeaderboardRanks(Leaderboard *leaderboard)
+{
+    if (!leaderboard->rankReady)
+    {
+        leaderboard->rankReady = buildRankIndex(&leaderboard->rank, leaderboard->table.keys, leaderboard->table.count);
+    }
+    return leaderboard->rankReady;
+}
+
+// Function to get a player's 1-based rank among all players; false if they have no record
+bool leaderboardRank(Leaderboard *leaderboard, const char *username, uint64_t *rank)
+{
+    long long slot = findScore(&leaderboard->store, username);
+    if (slot < 0 || !prepareLeaderboardRanks(leaderboard))
+    {
+        return false;
+    }
+    *rank = rankOfSlot(&leaderboard->rank, (uint64_t)slot);
+    return *rank != 0;
+}
+
+// Function to get up to radius players either side of a rank, best first;
+// returns the number of rows and the rank of the first one
+int leaderboardAround(Leaderboard *leaderboard, uint64_t rank, int radius, ScoreRow rows[], uint64_t *firstRank)
+{
+    if (!prepareLeaderboardRanks(leaderboard))
+    {
+        return 0;
+    }
+    uint64_t first = rank > (uint64_t)radius ? rank - radius : 1;
+    uint64_t last = rank + radius;
+    int count = 0;
+    for (uint64_t r = first; r <= last; r++)
+    {
+        long long slot = slotAtRank(&leaderboard->rank, r);
+        if (slot < 0)
+        {
+            break;
+        }
+        getScoreRow(&leaderboard->table, (uint64_t)slot, &rows[count++]);
+    }
+    *firstRank = first;
+    return count;
+}
+
+// Function to get how many rows the top-K list holds
+int leaderboardTopCount(const Leaderboard *leaderboard)
+{
+    return leaderboard->top.count;
+}
+
+// Function to get the row at a position of the top-K list (0 is the best)
+void leaderboardTopRow(Leaderboard *leaderboard, int position, ScoreRow *row)
+{
+    getScoreRow(&leaderboard->table, topScoresView(&leaderboard->top)[position].slot, row);
+}
+
+// Function to get the number of players on the leaderboard
+uint64_t leaderboardSize(const Leaderboard *leaderboard)
+{
+    return storeScoreCount(&leaderboard->store);
+}
@@ -0,0 +1,41 @@
+// Leaderboard engine
+// Wraps the score store with a columnar copy of every player, a top-K heap
+// that absorbs every submission in O(log K), so showing the best players
+// never needs a sort or a full scan, and a rank index (built on first use)
+// for ranks, neighbours and percentiles
+
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "score_store.h"
+#include "rank_index.h"
+#include "score_table.h"
+#include "top_scores.h"
+
+// Structure to store an open leaderboard
+typedef struct
+{
+    ScoreStore store;
+    ScoreTable table;
+    TopScores top;
+    RankIndex rank;
+    bool rankReady;
+} Leaderboard;
+
+// Function prototypes
+bool openLeaderboard(Leaderboard *leaderboard, const char *path, const char *legacyPath, int topSize);
+void closeLeaderboard(Leaderboard *leaderboard);
+bool submitScore(Leaderboard *leaderboard, const char *username, int time, double successRatio);
+bool stageScore(Leaderboard *leaderboard, const char *username, int time, double successRatio, JournalEntry *entry);
+bool refreshLeaderboard(Leaderboard *leaderboard);
+bool reopenLeaderboard(Leaderboard *leaderboard);
+int leaderboardTopCount(const Leaderboard *leaderboard);
+void leaderboardTopRow(Leaderboard *leaderboard, int position, ScoreRow *row);
+uint64_t leaderboardSize(const Leaderboard *leaderboard);
+bool prepareLeaderboardRanks(Leaderboard *leaderboard);
+bool leaderboardRank(Leaderboard *leaderboard, const char *username, uint64_t *rank);
+int leaderboardAround(Leaderboard *leaderboard, uint64_t rank, int radius, ScoreRow rows[], uint64_t *firstRank);
+
+#endif
@@ -0,0 +1,224 @@
+// Process-wide leaderboard cache
+// Our own submissions go through the cached leaderboard, so they are in
+// memory already; the notifications they cause only cost two stats when the
+// cache finds nothing new in the journal. A prefetch does the slow parts
+// (catching up with other processes, building the rank index) on a thread
+// ahead of time, and every other call waits for it first.
+//
+// Instances on one host also share a small mapped file: its lock orders
+// their journal writes and compactions, and its top list is what the
+// leaderboard screen shows, read without waiting on anyone
+
+#include "leaderboard_cache.h"
+#include "file_watch.h"
+#include "score_writer.h"
+#include "score_key.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+static Leaderboard cache;
+static FileWatch cacheWatch;
+static ScoreWriter cacheWriter;
+static SharedScores cacheShared;
+static bool cacheOpen = false;
+static bool sharedOpen = false;
+static pthread_t prefetchThread;
+static bool prefetching = false;
+
+// Function to copy a row of a leaderboard's top list in the shared list's format
+static void copyTopRow(Leaderboard *leaderboard, int position, SharedScore *score)
+{
+    ScoreRow row;
+    leaderboardTopRow(leaderboard, position, &row);
+    memset(score, 0, sizeof(*score));
+    snprintf(score->username, sizeof(score->username), "%s", row.username);
+    score->time = row.time;
+    score->successRatio = row.successRatio;
+    score->key = row.key;
+}
+
+// Function to load the leaderboard once and start watching its files
+bool openLeaderboardCache(const char *path, const char *legacyPath, int topSize)
+{
+    if (cacheOpen)
+    {
+        return true;
+    }
+
+    // Watch before loading, so a run saved while loading is not missed
+    if (!openFileWatch(&cacheWatch, path))
+    {
+        printf("Leaderboard file watch could not be created, checking the files instead\n");
+    }
+    if (!openLeaderboard(&cache, path, legacyPath, topSize))
+    {
+        closeFileWatch(&cacheWatch);
+        return false;
+    }
+
+    // Join the other instances before anything is written, and add our top
+    // list to the shared one so a new shared file starts out complete
+    sharedOpen = sharedOpen || openSharedScores(&cacheShared, path, topSize);
+    if (sharedOpen)
+    {
+        setScoreStoreWriterLock(&cache.store, &cacheShared.header->writerLock);
+        SharedScore scores[SHARED_TOP_MAX];
+        int count = 0;
+        for (int i = 0; i < leaderboardTopCount(&cache) && count < SHARED_TOP_MAX; i++)
+        {
+            copyTopRow(&cache, i, &scores[count++]);
+        }
+        publishSharedScores(&cacheShared, scores, count);
+    }
+    else
+    {
+        printf("Shared leaderboard could not be opened, other instances' scores show up after they save\n");
+    }
+    startScoreWriter(&cacheWriter, &cache.store);
+    cacheOpen = true;
+    return true;
+}
+
+// Function to apply changes other processes made since the last check;
+// false if the files had to be reopened and could not be
+static bool refreshCache()
+{
+    if (!fileWatchChanged(&cacheWatch) || refreshLeaderboard(&cache))
+    {
+        return true;
+    }
+
+    // Another process replaced the files; our queued runs go into the old
+    // journal first, and the reopened leaderboard replays them from there
+    flushScoreWriter(&cacheWriter);
+    if (!reopenLeaderboard(&cache))
+    {
+        printf("Leaderboard could not be reloaded!\n");
+        stopScoreWriter(&cacheWriter);
+        closeFileWatch(&cacheWatch);
+        cacheOpen = false;
+        return false;
+    }
+    return true;
+}
+
+// Function to bring the cache up to date and build its rank index on the prefetch thread
+static void *prefetchWorker(void *context)
+{
+    (void)context;
+    if (refreshCache())
+    {
+        prepareLeaderboardRanks(&cache);
+    }
+    return NULL;
+}
+
+// Function to wait for a prefetch in progress, if any
+static void finishPrefetch()
+{
+    if (prefetching)
+    {
+        pthread_join(prefetchThread, NULL);
+        prefetching = false;
+    }
+}
+
+// Function to start getting the leaderboard ready in the background, so the
+// next cachedLeaderboard() call and the player's rank cost almost nothing.
+// Nothing else may use the cache until the next cachedLeaderboard() call
+void prefetchLeaderboardCache()
+{
+    if (!cacheOpen || prefetching)
+    {
+        return;
+    }
+
+    // Without a thread the work simply happens on first use
+    prefetching = pthread_create(&prefetchThread, NULL, prefetchWorker, NULL) == 0;
+}
+
+// Function to get the cached leaderboard, first applying changes other
+// processes made since the last call; NULL if the cache is not open
+Leaderboard *cachedLeaderboard()
+{
+    finishPrefetch();
+    if (!cacheOpen || !refreshCache())
+    {
+        return NULL;
+    }
+    return &cache;
+}
+
+// Function to save a player's run: the cached leaderboard shows it at once
+// and the worker writes it to disk; false if it did not improve their record
+bool submitCachedScore(const char *username, int time, double successRatio)
+{
+    Leaderboard *leaderboard = cachedLeaderboard();
+    JournalEntry entry;
+    if (leaderboard == NULL || !stageScore(leaderboard, username, time, successRatio, &entry))
+    {
+        return false;
+    }
+    queueScoreWrite(&cacheWriter, &entry);
+    if (sharedOpen)
+    {
+        SharedScore score;
+        memset(&score, 0, sizeof(score));
+        memcpy(score.username, entry.username, SCORE_NAME_SIZE);
+        score.time = entry.time;
+        score.successRatio = entry.successRatio;
+        score.key = scoreKey(entry.successRatio, entry.time, entry.sequence);
+        publishSharedScores(&cacheShared, &score, 1);
+    }
+    return true;
+}
+
+// Function to read up to maxScores of the best scores of every instance on
+// the host, best first; it never waits on writers or reads the files
+int readCachedTopScores(SharedScore scores[], int maxScores)
+{
+    int count = sharedOpen ? readSharedScores(&cacheShared, scores, maxScores) : -1;
+    if (count >= 0)
+    {
+        return count;
+    }
+
+    // Without a readable shared list the cached leaderboard is the best we have
+    Leaderboard *leaderboard = cachedLeaderboard();
+    count = 0;
+    for (int i = 0; leaderboard != NULL && i < leaderboardTopCount(leaderboard) && count < maxScores; i++)
+    {
+        copyTopRow(leaderboard, i, &scores[count++]);
+    }
+    return count;
+}
+
+// Function to wait until every run saved through the cache is on disk
+void flushLeaderboardCache()
+{
+    finishPrefetch();
+    if (cacheOpen)
+    {
+        flushScoreWriter(&cacheWriter);
+    }
+}
+
+// Function to close the cached leaderboard and stop watching its files
+void closeLeaderboardCache()
+{
+    finishPrefetch();
+    if (cacheOpen)
+    {
+        // Every queued run is written before the store closes
+        stopScoreWriter(&cacheWriter);
+        closeLeaderboard(&cache);
+        closeFileWatch(&cacheWatch);
+        cacheOpen = false;
+    }
+    if (sharedOpen)
+    {
+        closeSharedScores(&cacheShared);
+        sharedOpen = false;
+    }
+}
@@ -0,0 +1,24 @@
+// Process-wide leaderboard cache
+// The leaderboard is loaded once and then kept up to date in memory; the
+// files are only read again when a change notification says another process
+// saved a run, so showing the leaderboard normally costs no file reads.
+// Runs saved through the cache are written to disk by a background worker,
+// and the top scores are shared live with other game instances on the host
+
+#ifndef LEADERBOARD_CACHE_H
+#define LEADERBOARD_CACHE_H
+
+#include <stdbool.h>
+#include "leaderboard.h"
+#include "shared_scores.h"
+
+// Function prototypes
+bool openLeaderboardCache(const char *path, const char *legacyPath, int topSize);
+void prefetchLeaderboardCache();
+Leaderboard *cachedLeaderboard();
+bool submitCachedScore(const char *username, int time, double successRatio);
+int readCachedTopScores(SharedScore scores[], int maxScores);
+void flushLeaderboardCache();
+void closeLeaderboardCache();
+
+#endif
@@ -0,0 +1,279 @@
+// Client for the leaderboard daemon
+// The few platform differences (Winsock start-up, closing a socket, Unix
+// domain sockets) stay in the socket helpers at the top
+
+#include "leaderboard_client.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#define INVALID_CLIENT_SOCKET INVALID_SOCKET
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define INVALID_CLIENT_SOCKET -1
+#endif
+
+// A daemon that went away must not kill the game with SIGPIPE
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+// Function to close a socket
+static void closeSocket(LeaderboardClient *client)
+{
+    if (client->connected)
+    {
+#ifdef _WIN32
+        closesocket(client->socket);
+#else
+        close(client->socket);
+#endif
+    }
+    client->socket = INVALID_CLIENT_SOCKET;
+    client->connected = false;
+}
+
+// Function to connect to a Unix domain socket
+static bool connectUnix(LeaderboardClient *client, const char *path)
+{
+#ifdef _WIN32
+    (void)client;
+    printf("Unix domain socket %s is not supported on Windows, use HOST:PORT\n", path);
+    return false;
+#else
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        return false;
+    }
+    strcpy(address.sun_path, path);
+    client->socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client->socket < 0)
+    {
+        return false;
+    }
+    if (connect(client->socket, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        close(client->socket);
+        return false;
+    }
+    client->connected = true;
+    return true;
+#endif
+}
+
+// Function to connect over TCP to HOST:PORT, or PORT on localhost
+static bool connectTcp(LeaderboardClient *client, const char *address)
+{
+#ifdef _WIN32
+    static bool started = false;
+    WSADATA data;
+    if (!started && WSAStartup(MAKEWORD(2, 2), &data) != 0)
+    {
+        return false;
+    }
+    started = true;
+#endif
+    char host[SCORE_PATH_SIZE];
+    const char *colon = strrchr(address, ':');
+    const char *port = colon ? colon + 1 : address;
+    snprintf(host, sizeof(host), "%.*s", colon ? (int)(colon - address) : 0, address);
+
+    struct addrinfo hints, *found;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host[0] ? host : "127.0.0.1", port, &hints, &found) != 0)
+    {
+        return false;
+    }
+    for (struct addrinfo *candidate = found; candidate != NULL && !client->connected; candidate = candidate->ai_next)
+    {
+        client->socket = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+        if (client->socket == INVALID_CLIENT_SOCKET)
+        {
+            continue;
+        }
+        client->connected = true;
+        if (connect(client->socket, candidate->ai_addr, (int)candidate->ai_addrlen) != 0)
+        {
+            closeSocket(client);
+        }
+    }
+    freeaddrinfo(found);
+    if (client->connected)
+    {
+        // Requests are tiny and answered at once, so they must not wait for Nagle
+        int on = 1;
+        setsockopt(client->socket, IPPROTO_TCP, TCP_NODELAY, (const char *)&on, sizeof(on));
+    }
+    return client->connected;
+}
+
+// Function to (re)connect to the address the client was opened with
+static bool reconnect(LeaderboardClient *client)
+{
+    closeSocket(client);
+    if (strncmp(client->address, "unix:", 5) == 0)
+    {
+        return connectUnix(client, client->address + 5);
+    }
+    return connectTcp(client, client->address);
+}
+
+// Function to send a whole buffer
+static bool sendAll(LeaderboardClient *client, const void *data, size_t size)
+{
+    for (size_t done = 0; done < size;)
+    {
+        int sent = (int)send(client->socket, (const char *)data + done, (int)(size - done), SEND_FLAGS);
+        if (sent <= 0)
+        {
+            return false;
+        }
+        done += (size_t)sent;
+    }
+    return true;
+}
+
+// Function to receive exactly size bytes
+static bool receiveAll(LeaderboardClient *client, void *data, size_t size)
+{
+    for (size_t done = 0; done < size;)
+    {
+        int got = (int)recv(client->socket, (char *)data + done, (int)(size - done), 0);
+        if (got <= 0)
+        {
+            return false;
+        }
+        done += (size_t)got;
+    }
+    return true;
+}
+
+// Function to send one request and read its reply into reply (header) and
+// body (at most capacity bytes); false if the daemon could not be reached or refused it
+static bool exchange(LeaderboardClient *client, const LeaderboardHeader *request, const void *requestBody, LeaderboardHeader *reply, void *body, size_t capacity)
+{
+    // A connection the daemon closed (it restarted, say) only shows up when used, so each call gets one retry
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        if (!client->connected && !reconnect(client))
+        {
+            return false;
+        }
+        if (sendAll(client, request, sizeof(*request)) && sendAll(client, requestBody, request->size) && receiveAll(client, reply, sizeof(*reply)))
+        {
+            if (reply->size > capacity || !receiveAll(client, body, reply->size))
+            {
+                closeSocket(client);
+                return false;
+            }
+            return reply->type == request->type;
+        }
+        closeSocket(client);
+    }
+    return false;
+}
+
+// Function to connect to the daemon at address
+bool connectLeaderboardClient(LeaderboardClient *client, const char *address)
+{
+    memset(client, 0, sizeof(*client));
+    client->socket = INVALID_CLIENT_SOCKET;
+    snprintf(client->address, sizeof(client->address), "%s", address);
+    return reconnect(client);
+}
+
+// Function to close the connection
+void closeLeaderboardClient(LeaderboardClient *client)
+{
+    closeSocket(client);
+}
+
+// Function to save a player's run; improved (optional) tells whether it beat their record
+bool clientSubmitScore(LeaderboardClient *client, const char *username, int time, double successRatio, bool *improved)
+{
+    LeaderboardRow row;
+    memset(&row, 0, sizeof(row));
+    snprintf(row.username, sizeof(row.username), "%s", username);
+    row.time = time;
+    row.successRatio = successRatio;
+    LeaderboardHeader request = {MESSAGE_SUBMIT, 0, sizeof(row)};
+    LeaderboardHeader reply;
+    LeaderboardRank rank;
+    if (!exchange(client, &request, &row, &reply, &rank, sizeof(rank)))
+    {
+        return false;
+    }
+    if (improved)
+    {
+        *improved = reply.count != 0;
+    }
+    return true;
+}
+
+// Function to get up to maxRows of the best players, best first; -1 on error
+int clientTopScores(LeaderboardClient *client, LeaderboardRow rows[], int maxRows)
+{
+    int wanted = maxRows < LEADERBOARD_MAX_ROWS ? maxRows : LEADERBOARD_MAX_ROWS;
+    LeaderboardHeader request = {MESSAGE_TOP, (uint16_t)wanted, 0};
+    LeaderboardHeader reply;
+    if (!exchange(client, &request, NULL, &reply, rows, sizeof(LeaderboardRow) * wanted))
+    {
+        return -1;
+    }
+    return (int)(reply.size / sizeof(LeaderboardRow));
+}
+
+// Function to get a player's 1-based rank and the number of players; false if they have no record or on error
+bool clientPlayerRank(LeaderboardClient *client, const char *username, uint64_t *rank, uint64_t *total)
+{
+    char name[SCORE_NAME_SIZE];
+    memset(name, 0, sizeof(name));
+    snprintf(name, sizeof(name), "%s", username);
+    LeaderboardHeader request = {MESSAGE_RANK, 0, sizeof(name)};
+    LeaderboardHeader reply;
+    LeaderboardRank answer;
+    if (!exchange(client, &request, name, &reply, &answer, sizeof(answer)) || reply.size != sizeof(answer))
+    {
+        return false;
+    }
+    *rank = answer.rank;
+    *total = answer.total;
+    return answer.rank != 0;
+}
+
+// Function to get up to radius players either side of a player, best first,
+// and the rank of the first one; -1 if they have no record or on error
+int clientAroundPlayer(LeaderboardClient *client, const char *username, int radius, LeaderboardRow rows[], uint64_t *firstRank)
+{
+    char name[SCORE_NAME_SIZE];
+    memset(name, 0, sizeof(name));
+    snprintf(name, sizeof(name), "%s", username);
+    int wanted = radius < LEADERBOARD_MAX_RADIUS ? radius : LEADERBOARD_MAX_RADIUS;
+    LeaderboardHeader request = {MESSAGE_AROUND, (uint16_t)wanted, sizeof(name)};
+    LeaderboardHeader reply;
+    char body[sizeof(LeaderboardRank) + sizeof(LeaderboardRow) * (LEADERBOARD_MAX_RADIUS * 2 + 1)];
+    if (!exchange(client, &request, name, &reply, body, sizeof(body)) || reply.size < sizeof(LeaderboardRank))
+    {
+        return -1;
+    }
+    LeaderboardRank first;
+    memcpy(&first, body, sizeof(first));
+    int count = (int)((reply.size - sizeof(first)) / sizeof(LeaderboardRow));
+    memcpy(rows, body + sizeof(first), sizeof(LeaderboardRow) * count);
+    *firstRank = first.rank;
+    return first.rank != 0 ? count : -1;
+}
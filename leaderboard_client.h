@@ -0,0 +1,38 @@
+// Client for the leaderboard daemon
+// Blocking calls over one connection, to a Unix domain socket ("unix:PATH",
+// not on Windows) or TCP ("HOST:PORT" or just "PORT" for localhost). Every
+// request is safe to send twice, so a call whose connection dropped is sent
+// again once over a fresh connection
+
+#ifndef LEADERBOARD_CLIENT_H
+#define LEADERBOARD_CLIENT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "leaderboard_protocol.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#endif
+
+// Structure to store a connection to the daemon
+typedef struct
+{
+#ifdef _WIN32
+    SOCKET socket;
+#else
+    int socket;
+#endif
+    bool connected;
+    char address[SCORE_PATH_SIZE];
+} LeaderboardClient;
+
+// Function prototypes
+bool connectLeaderboardClient(LeaderboardClient *client, const char *address);
+void closeLeaderboardClient(LeaderboardClient *client);
+bool clientSubmitScore(LeaderboardClient *client, const char *username, int time, double successRatio, bool *improved);
+int clientTopScores(LeaderboardClient *client, LeaderboardRow rows[], int maxRows);
+bool clientPlayerRank(LeaderboardClient *client, const char *username, uint64_t *rank, uint64_t *total);
+int clientAroundPlayer(LeaderboardClient *client, const char *username, int radius, LeaderboardRow rows[], uint64_t *firstRank);
+
+#endif
@@ -0,0 +1,57 @@
+// Leaderboard daemon protocol
+// Every message is a fixed 8-byte header followed by size bytes of body, in
+// the host's byte order (client and daemon run on the same machine). A
+// client can send several requests without waiting; replies come back in
+// the order the requests were sent
+//
+// Request            count         body                    reply body
+// SUBMIT             -             LeaderboardRow          LeaderboardRank, count = 1 if the run improved
+// TOP                rows wanted   -                       count LeaderboardRow
+// RANK               -             username                LeaderboardRank (rank 0: no record)
+// AROUND             radius        username                LeaderboardRank of the first row, then count LeaderboardRow
+
+#ifndef LEADERBOARD_PROTOCOL_H
+#define LEADERBOARD_PROTOCOL_H
+
+#include <stdint.h>
+#include "score_store.h"
+
+#define LEADERBOARD_DEFAULT_PORT 7787
+#define LEADERBOARD_DEFAULT_SOCKET "leaderboard.sock"
+#define LEADERBOARD_MAX_ROWS 256
+#define LEADERBOARD_MAX_RADIUS 16
+
+// Message types; a reply has the type of its request, or ERROR if it failed
+#define MESSAGE_SUBMIT 1
+#define MESSAGE_TOP 2
+#define MESSAGE_RANK 3
+#define MESSAGE_AROUND 4
+#define MESSAGE_ERROR 0xffff
+
+// Structure of the header in front of every message
+typedef struct
+{
+    uint16_t type;
+    uint16_t count;
+    uint32_t size;
+} LeaderboardHeader;
+
+// Structure of one player's run on the wire
+typedef struct
+{
+    char username[SCORE_NAME_SIZE];
+    int32_t time;
+    double successRatio;
+} LeaderboardRow;
+
+// Structure of a rank reply
+typedef struct
+{
+    uint64_t rank;
+    uint64_t total;
+} LeaderboardRank;
+
+// The biggest message either side sends
+#define LEADERBOARD_MAX_MESSAGE (sizeof(LeaderboardHeader) + sizeof(LeaderboardRank) + sizeof(LeaderboardRow) * LEADERBOARD_MAX_ROWS)
+
+#endif
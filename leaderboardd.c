@@ -0,0 +1,425 @@
+// Leaderboard daemon
+// Owns the score store and answers the leaderboard protocol (see
+// leaderboard_protocol.h) on a Unix domain socket and a localhost TCP port,
+// from one thread driven by epoll, so every game front end shares one
+// ranking and none of them has to load the score files. Linux only
+// Submitted runs are group committed: they are staged in memory, and their
+// replies held back, until one journal write and sync covers the whole batch
+// Build with "make leaderboardd" and run ./leaderboardd [--unix PATH] [--tcp PORT] [--file PATH] [--top K] [--window MICROSECONDS] [--batch N]
+
+#include "event_server.h"
+#include "leaderboard.h"
+#include "leaderboard_protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#define SERVER_INPUT_SIZE 65536
+#define SERVER_INITIAL_OUTPUT 65536
+#define SERVER_DEFAULT_FILE "highscore.dat"
+#define SERVER_DEFAULT_BATCH 1024
+
+// Most submits one connection can stage between two checks of the batch size
+#define SERVER_SUBMITS_PER_READ (SERVER_INPUT_SIZE / (sizeof(LeaderboardHeader) + sizeof(LeaderboardRow)) + 1)
+
+// Structure to store a submit reply that is sent once its batch is durable; a
+// connection holds its replies from the first of them on until the commit
+typedef struct
+{
+    EventConnection *connection;
+    size_t offset;
+} PendingReply;
+
+// Structure to store the daemon's state
+typedef struct
+{
+    Leaderboard leaderboard;
+    EventServer events;
+    uint64_t requests;
+
+    // Group commit: journal entries of the staged runs and the replies waiting on them
+    JournalEntry *batch;
+    int batchCount;
+    PendingReply *pending;
+    int pendingCount;
+    int batchLimit;
+    long window;
+    int timer;
+    bool timerArmed;
+    uint64_t commits;
+} Server;
+
+// Function to forget the replies a closing connection still has waiting on a commit
+static void dropPendingReplies(void *owner, EventConnection *connection)
+{
+    Server *server = (Server *)owner;
+    for (int i = 0; connection->holding && i < server->pendingCount; i++)
+    {
+        if (server->pending[i].connection == connection)
+        {
+            server->pending[i].connection = NULL;
+        }
+    }
+}
+
+// Function to queue a reply with the given type, count and body parts
+static bool queueReply(EventConnection *connection, uint16_t type, uint16_t count, const void *first, size_t firstSize, const void *rest, size_t restSize)
+{
+    LeaderboardHeader header = {type, count, (uint32_t)(firstSize + restSize)};
+    if (!reserveOutput(connection, sizeof(header) + firstSize + restSize))
+    {
+        return false;
+    }
+    char *out = connection->output + connection->outputUsed;
+    memcpy(out, &header, sizeof(header));
+    if (firstSize > 0)
+    {
+        memcpy(out + sizeof(header), first, firstSize);
+    }
+    if (restSize > 0)
+    {
+        memcpy(out + sizeof(header) + firstSize, rest, restSize);
+    }
+    connection->outputUsed += sizeof(header) + firstSize + restSize;
+    return true;
+}
+
+// Function to copy a leaderboard row into its wire form
+static void copyRow(const ScoreRow *row, LeaderboardRow *wire)
+{
+    memset(wire, 0, sizeof(*wire));
+    snprintf(wire->username, sizeof(wire->username), "%s", row->username);
+    wire->time = row->time;
+    wire->successRatio = row->successRatio;
+}
+
+// Function to answer one request; false if the connection has to be closed
+static bool handleRequest(Server *server, EventConnection *connection, const LeaderboardHeader *header, const char *body)
+{
+    Leaderboard *leaderboard = &server->leaderboard;
+    LeaderboardRow rows[LEADERBOARD_MAX_ROWS];
+    LeaderboardRank answer = {0, leaderboardSize(leaderboard)};
+    char username[SCORE_NAME_SIZE];
+    server->requests++;
+
+    // Every request but TOP carries a username first
+    if (header->type != MESSAGE_TOP && header->size >= SCORE_NAME_SIZE)
+    {
+        memcpy(username, body, SCORE_NAME_SIZE);
+        username[SCORE_NAME_SIZE - 1] = '\0';
+    }
+
+    switch (header->type)
+    {
+    case MESSAGE_SUBMIT:
+    {
+        LeaderboardRow run;
+        if (header->size != sizeof(run))
+        {
+            break;
+        }
+        memcpy(&run, body, sizeof(run));
+        if (username[0] == '\0' || run.time < 0 || !(run.successRatio >= 0.0 && run.successRatio <= 100.0))
+        {
+            break;
+        }
+        // The run counts in memory at once, but is only acknowledged once its batch is on disk
+        JournalEntry entry;
+        bool improved = stageScore(leaderboard, username, run.time, run.successRatio, &entry);
+        if (improved)
+        {
+            server->batch[server->batchCount++] = entry;
+        }
+        leaderboardRank(leaderboard, username, &answer.rank);
+        answer.total = leaderboardSize(leaderboard);
+        size_t offset = connection->outputUsed;
+        if (!queueReply(connection, MESSAGE_SUBMIT, improved ? 1 : 0, &answer, sizeof(answer), NULL, 0))
+        {
+            return false;
+        }
+
+        // A run that did not improve still waits if a batch is open, since it was judged against staged runs
+        if (server->batchCount > 0)
+        {
+            if (!connection->holding)
+            {
+                connection->holding = true;
+                connection->outputHeld = offset;
+            }
+            server->pending[server->pendingCount].connection = connection;
+            server->pending[server->pendingCount].offset = offset;
+            server->pendingCount++;
+            if (server->window > 0 && !server->timerArmed)
+            {
+                struct itimerspec deadline;
+                memset(&deadline, 0, sizeof(deadline));
+                deadline.it_value.tv_sec = server->window / 1000000;
+                deadline.it_value.tv_nsec = server->window % 1000000 * 1000;
+                server->timerArmed = timerfd_settime(server->timer, 0, &deadline, NULL) == 0;
+            }
+        }
+        return true;
+    }
+    case MESSAGE_TOP:
+    {
+        if (header->size != 0)
+        {
+            break;
+        }
+        int count = leaderboardTopCount(leaderboard);
+        count = count < header->count ? count : header->count;
+        count = count < LEADERBOARD_MAX_ROWS ? count : LEADERBOARD_MAX_ROWS;
+        for (int i = 0; i < count; i++)
+        {
+            ScoreRow row;
+            leaderboardTopRow(leaderboard, i, &row);
+            copyRow(&row, &rows[i]);
+        }
+        return queueReply(connection, MESSAGE_TOP, (uint16_t)count, rows, sizeof(LeaderboardRow) * count, NULL, 0);
+    }
+    case MESSAGE_RANK:
+    {
+        if (header->size != SCORE_NAME_SIZE)
+        {
+            break;
+        }
+        leaderboardRank(leaderboard, username, &answer.rank);
+        return queueReply(connection, MESSAGE_RANK, 0, &answer, sizeof(answer), NULL, 0);
+    }
+    case MESSAGE_AROUND:
+    {
+        if (header->size != SCORE_NAME_SIZE)
+        {
+            break;
+        }
+        int count = 0;
+        uint64_t rank;
+        if (leaderboardRank(leaderboard, username, &rank))
+        {
+            ScoreRow around[LEADERBOARD_MAX_RADIUS * 2 + 1];
+            int radius = header->count < LEADERBOARD_MAX_RADIUS ? header->count : LEADERBOARD_MAX_RADIUS;
+            count = leaderboardAround(leaderboard, rank, radius, around, &answer.rank);
+            for (int i = 0; i < count; i++)
+            {
+                copyRow(&around[i], &rows[i]);
+            }
+        }
+        return queueReply(connection, MESSAGE_AROUND, (uint16_t)count, &answer, sizeof(answer), rows, sizeof(LeaderboardRow) * count);
+    }
+    }
+
+    // A request that is malformed (or of an unknown type) still gets a reply, so replies stay in order
+    return queueReply(connection, MESSAGE_ERROR, 0, NULL, 0, NULL, 0);
+}
+
+// Function to answer every complete request in the input buffer; false if the connection has to be closed
+static bool handleInput(void *owner, EventConnection *connection)
+{
+    Server *server = (Server *)owner;
+    size_t used = 0;
+    while (connection->inputUsed - used >= sizeof(LeaderboardHeader))
+    {
+        LeaderboardHeader header;
+        memcpy(&header, connection->input + used, sizeof(header));
+        if (header.size > sizeof(LeaderboardRow))
+        {
+            // No request is this big, so the stream is out of step
+            return false;
+        }
+        if (connection->inputUsed - used < sizeof(header) + header.size)
+        {
+            break;
+        }
+        if (!handleRequest(server, connection, &header, connection->input + used + sizeof(header)))
+        {
+            return false;
+        }
+        used += sizeof(header) + header.size;
+    }
+    memmove(connection->input, connection->input + used, connection->inputUsed - used);
+    connection->inputUsed -= used;
+    return true;
+}
+
+// Function to write the open batch to the journal with one sync and release the replies waiting on it
+static void commitBatch(Server *server)
+{
+    if (server->pendingCount == 0)
+    {
+        return;
+    }
+    if (server->timerArmed)
+    {
+        struct itimerspec off;
+        memset(&off, 0, sizeof(off));
+        timerfd_settime(server->timer, 0, &off, NULL);
+        server->timerArmed = false;
+    }
+
+    // If the write fails the runs stay in memory, but their submitters are told they were not saved
+    bool ok = writeJournal(&server->leaderboard.store, server->batch, server->batchCount);
+    if (!ok)
+    {
+        printf("%d score(s) could not be saved!\n", server->batchCount);
+    }
+    server->commits++;
+    int count = server->pendingCount;
+    server->batchCount = 0;
+    server->pendingCount = 0;
+    if (!ok)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (server->pending[i].connection != NULL)
+            {
+                uint16_t type = MESSAGE_ERROR;
+                memcpy(server->pending[i].connection->output + server->pending[i].offset, &type, sizeof(type));
+            }
+        }
+    }
+
+    // Every connection with a reply in the batch lets its replies go once
+    for (int i = 0; i < count; i++)
+    {
+        EventConnection *connection = server->pending[i].connection;
+        if (connection == NULL || !connection->holding)
+        {
+            continue;
+        }
+        // A connection that fails here is closed when epoll next reports it, since it may still be in this pass's events
+        connection->holding = false;
+        flushOutput(connection);
+        rewatchConnection(&server->events, connection);
+    }
+}
+
+// Function to commit the batch when the commit timer expires
+static void expireWindow(void *owner)
+{
+    Server *server = (Server *)owner;
+    uint64_t expirations;
+    if (read(server->timer, &expirations, sizeof(expirations)) > 0)
+    {
+        server->timerArmed = false;
+        commitBatch(server);
+    }
+}
+
+// Function to commit the batch once it is full
+static void checkBatch(void *owner)
+{
+    Server *server = (Server *)owner;
+    if (server->pendingCount >= server->batchLimit)
+    {
+        commitBatch(server);
+    }
+}
+
+// Function to commit the runs of a whole pass together when there is no window
+static void endPass(void *owner)
+{
+    Server *server = (Server *)owner;
+    if (server->window <= 0)
+    {
+        commitBatch(server);
+    }
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+    const char *unixPath = NULL;
+    const char *file = SERVER_DEFAULT_FILE;
+    int port = 0;
+    int topSize = LEADERBOARD_MAX_ROWS;
+    long window = 0;
+    int batchLimit = SERVER_DEFAULT_BATCH;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--unix") == 0)
+        {
+            unixPath = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--tcp") == 0)
+        {
+            port = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--file") == 0)
+        {
+            file = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--top") == 0)
+        {
+            topSize = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--window") == 0)
+        {
+            window = atol(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--batch") == 0)
+        {
+            batchLimit = atoi(argv[i + 1]) > 0 ? atoi(argv[i + 1]) : 1;
+        }
+    }
+
+    // Without --unix or --tcp, listen on both defaults
+    if (unixPath == NULL && port == 0)
+    {
+        unixPath = LEADERBOARD_DEFAULT_SOCKET;
+        port = LEADERBOARD_DEFAULT_PORT;
+    }
+
+    // The batch is checked after each connection is served, so it can run over its limit by one read's worth
+    Server server;
+    memset(&server, 0, sizeof(server));
+    server.window = window;
+    server.batchLimit = batchLimit;
+    server.batch = (JournalEntry *)malloc(sizeof(JournalEntry) * (batchLimit + SERVER_SUBMITS_PER_READ));
+    server.pending = (PendingReply *)malloc(sizeof(PendingReply) * (batchLimit + SERVER_SUBMITS_PER_READ));
+    if (server.batch == NULL || server.pending == NULL)
+    {
+        printf("Commit batch could not be created!\n");
+        return 1;
+    }
+    if (!openLeaderboard(&server.leaderboard, file, NULL, topSize))
+    {
+        printf("Leaderboard %s could not be opened!\n", file);
+        return 1;
+    }
+
+    // Build the rank index up front so no request pays for it
+    prepareLeaderboardRanks(&server.leaderboard);
+
+    EventHandlers handlers = {handleInput, dropPendingReplies, expireWindow, checkBatch, endPass};
+    initEventServer(&server.events, SERVER_INPUT_SIZE, SERVER_INITIAL_OUTPUT, handlers, &server);
+    server.timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (server.timer < 0 || !openListeners(&server.events, unixPath, port) || !startEventLoop(&server.events, 0))
+    {
+        closeListeners(&server.events);
+        closeLeaderboard(&server.leaderboard);
+        return 1;
+    }
+
+    // The commit timer is the one watched descriptor without a connection
+    watchEventSource(&server.events, server.timer);
+    catchStopSignals();
+    printf("Leaderboard daemon serving %llu players from %s (commit window %ld us, batch %d)\n", (unsigned long long)leaderboardSize(&server.leaderboard), file, window, batchLimit);
+
+    // Every ready socket is served in turn, and without a window the runs
+    // they submitted are committed together after the pass
+    runEventLoop(&server.events);
+
+    // Client connections close with the process; the store is flushed and closed properly
+    commitBatch(&server);
+    printf("Leaderboard daemon stopping after %llu requests and %llu commits\n", (unsigned long long)server.requests, (unsigned long long)server.commits);
+    closeListeners(&server.events);
+    close(server.timer);
+    closeEventLoop(&server.events);
+    free(server.batch);
+    free(server.pending);
+    flushScoreStore(&server.leaderboard.store);
+    closeLeaderboard(&server.leaderboard);
+    return 0;
+}
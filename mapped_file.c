@@ -0,0 +1,604 @@
+// Memory-mapped file helpers
+// Shared mappings are read-write views of the file; a file smaller than the
+// requested size is extended with zeros before it is mapped. Private mappings
+// are copy-on-write: changes stay in memory and the file is never modified,
+// which lets the file be replaced with rename while it is still in use
+
+#include "mapped_file.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <libgen.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Function to check whether two stamps describe the same version of a file
+bool sameFileStamp(const FileStamp *a, const FileStamp *b)
+{
+    return a->id == b->id && a->size == b->size && a->modified == b->modified;
+}
+
+#ifdef _WIN32
+
+// Function to map the whole file, growing it to at least size bytes
+static bool mapHandle(MappedFile *mapped, size_t size)
+{
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(mapped->file, &fileSize))
+    {
+        return false;
+    }
+    if ((size_t)fileSize.QuadPart > size)
+    {
+        size = (size_t)fileSize.QuadPart;
+    }
+    if (size == 0)
+    {
+        mapped->data = NULL;
+        mapped->size = 0;
+        return true;
+    }
+
+    // Creating a mapping larger than the file extends the file
+    mapped->mapping = CreateFileMappingA(mapped->file, NULL, PAGE_READWRITE, (DWORD)((unsigned long long)size >> 32), (DWORD)(size & 0xffffffffu), NULL);
+    if (mapped->mapping == NULL)
+    {
+        return false;
+    }
+    mapped->data = MapViewOfFile(mapped->mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (mapped->data == NULL)
+    {
+        CloseHandle(mapped->mapping);
+        mapped->mapping = NULL;
+        return false;
+    }
+    mapped->size = size;
+    return true;
+}
+
+// Function to drop the current view and mapping, keeping the file open
+static void unmapHandle(MappedFile *mapped)
+{
+    if (mapped->isPrivate)
+    {
+        if (mapped->data)
+        {
+            VirtualFree(mapped->data, 0, MEM_RELEASE);
+        }
+    }
+    else
+    {
+        if (mapped->data)
+        {
+            UnmapViewOfFile(mapped->data);
+        }
+        if (mapped->mapping)
+        {
+            CloseHandle(mapped->mapping);
+        }
+    }
+    mapped->data = NULL;
+    mapped->mapping = NULL;
+    mapped->size = 0;
+}
+
+// Function to open and map a file
+bool mapFile(MappedFile *mapped, const char *path, size_t minSize, bool create)
+{
+    memset(mapped, 0, sizeof(*mapped));
+    mapped->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                               create ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mapped->file == INVALID_HANDLE_VALUE)
+    {
+        mapped->file = NULL;
+        return false;
+    }
+    if (!mapHandle(mapped, minSize))
+    {
+        CloseHandle(mapped->file);
+        mapped->file = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Function to load a private copy of a file; Windows cannot replace a file
+// while a mapped view of it exists, so the copy is read into memory instead
+bool mapFilePrivate(MappedFile *mapped, const char *path)
+{
+    memset(mapped, 0, sizeof(*mapped));
+    mapped->isPrivate = true;
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    bool ok = GetFileSizeEx(file, &fileSize) != 0;
+    size_t size = ok ? (size_t)fileSize.QuadPart : 0;
+    if (ok && size > 0)
+    {
+        mapped->data = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        ok = mapped->data != NULL;
+        for (size_t done = 0; ok && done < size;)
+        {
+            DWORD chunk = (DWORD)(size - done > 0x40000000 ? 0x40000000 : size - done);
+            DWORD got = 0;
+            ok = ReadFile(file, (char *)mapped->data + done, chunk, &got, NULL) && got > 0;
+            done += got;
+        }
+    }
+    CloseHandle(file);
+    if (!ok)
+    {
+        unmapHandle(mapped);
+        return false;
+    }
+    mapped->size = size;
+    return true;
+}
+
+// Function to grow the file (or private copy) and map it again at its new size
+bool resizeMappedFile(MappedFile *mapped, size_t size)
+{
+    if (mapped->isPrivate)
+    {
+        void *data = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (data == NULL)
+        {
+            return false;
+        }
+        memcpy(data, mapped->data, mapped->size < size ? mapped->size : size);
+        unmapHandle(mapped);
+        mapped->data = data;
+        mapped->size = size;
+        return true;
+    }
+    unmapHandle(mapped);
+    return mapHandle(mapped, size);
+}
+
+// Function to write a changed range of the mapping back to disk
+bool syncMappedRange(MappedFile *mapped, size_t offset, size_t length)
+{
+    if (mapped->isPrivate)
+    {
+        return true;
+    }
+    if (!FlushViewOfFile((char *)mapped->data + offset, length))
+    {
+        return false;
+    }
+    return FlushFileBuffers(mapped->file) != 0;
+}
+
+// Function to unmap and close the file
+void unmapFile(MappedFile *mapped)
+{
+    unmapHandle(mapped);
+    if (mapped->file)
+    {
+        CloseHandle(mapped->file);
+    }
+    memset(mapped, 0, sizeof(*mapped));
+}
+
+// Function to check whether a file exists
+bool fileExists(const char *path)
+{
+    return GetFileAttributesA(path) != INVALID_FILE_ATTRIBUTES;
+}
+
+// Function to read the stamp of an open file
+static bool readHandleStamp(HANDLE file, FileStamp *stamp)
+{
+    BY_HANDLE_FILE_INFORMATION info;
+    if (GetFileInformationByHandle(file, &info) == 0)
+    {
+        return false;
+    }
+    stamp->id = ((uint64_t)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+    stamp->size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    stamp->modified = (int64_t)(((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime);
+    return true;
+}
+
+// Function to get the stamp of a file; false (and a zeroed stamp) if it is missing
+bool readFileStamp(const char *path, FileStamp *stamp)
+{
+    memset(stamp, 0, sizeof(*stamp));
+    HANDLE file = CreateFileA(path, 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    bool ok = readHandleStamp(file, stamp);
+    CloseHandle(file);
+    return ok;
+}
+
+// Function to replace a file with new contents so readers see either all of the old file or all of the new one
+bool writeFileAtomically(const char *path, const void *data, size_t size)
+{
+    // The temporary name is per process, so instances replacing the same file never write into each other's copy
+    char tempPath[MAX_PATH + 24];
+    snprintf(tempPath, sizeof(tempPath), "%s.%lu.tmp", path, (unsigned long)GetCurrentProcessId());
+    HANDLE file = CreateFileA(tempPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    bool ok = true;
+    for (size_t done = 0; ok && done < size;)
+    {
+        DWORD chunk = (DWORD)(size - done > 0x40000000 ? 0x40000000 : size - done);
+        DWORD written = 0;
+        ok = WriteFile(file, (const char *)data + done, chunk, &written, NULL) && written == chunk;
+        done += written;
+    }
+    ok = ok && FlushFileBuffers(file);
+    CloseHandle(file);
+    if (!ok || !MoveFileExA(tempPath, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        DeleteFileA(tempPath);
+        return false;
+    }
+    return true;
+}
+
+// Function to cut a file down to size bytes
+bool truncateFile(const char *path, size_t size)
+{
+    HANDLE file = CreateFileA(path, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER position;
+    position.QuadPart = (LONGLONG)size;
+    bool ok = SetFilePointerEx(file, position, NULL, FILE_BEGIN) && SetEndOfFile(file);
+    CloseHandle(file);
+    return ok;
+}
+
+// Function to open (or create) a file that is only ever appended to
+bool openAppendFile(AppendFile *file, const char *path)
+{
+    file->file = CreateFileA(path, FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file->file == INVALID_HANDLE_VALUE)
+    {
+        file->file = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Function to append bytes at the end of the file in one write; endOffset
+// (optional) receives where the write ended, which shows other writers' appends
+bool appendToFile(AppendFile *file, const void *data, size_t size, uint64_t *endOffset)
+{
+    DWORD written = 0;
+    if (!WriteFile(file->file, data, (DWORD)size, &written, NULL) || written != size)
+    {
+        return false;
+    }
+    if (endOffset)
+    {
+        LARGE_INTEGER zero, position;
+        zero.QuadPart = 0;
+        if (!SetFilePointerEx(file->file, zero, &position, FILE_CURRENT))
+        {
+            return false;
+        }
+        *endOffset = (uint64_t)position.QuadPart;
+    }
+    return true;
+}
+
+// Function to make everything appended so far durable
+bool syncAppendFile(AppendFile *file)
+{
+    return FlushFileBuffers(file->file) != 0;
+}
+
+// Function to read the stamp of the file an append-only file has open, which
+// differs from the path's stamp once another process has replaced the file
+bool readAppendFileStamp(const AppendFile *file, FileStamp *stamp)
+{
+    memset(stamp, 0, sizeof(*stamp));
+    return readHandleStamp(file->file, stamp);
+}
+
+// Function to close an append-only file
+void closeAppendFile(AppendFile *file)
+{
+    if (file->file)
+    {
+        CloseHandle(file->file);
+    }
+    file->file = NULL;
+}
+
+#else
+
+// Function to map the whole file, growing it to at least size bytes
+static bool mapDescriptor(MappedFile *mapped, size_t size)
+{
+    struct stat info;
+    if (fstat(mapped->fd, &info) != 0)
+    {
+        return false;
+    }
+    if ((size_t)info.st_size < size)
+    {
+        if (ftruncate(mapped->fd, (off_t)size) != 0)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        size = (size_t)info.st_size;
+    }
+    if (size == 0)
+    {
+        mapped->data = NULL;
+        mapped->size = 0;
+        return true;
+    }
+
+    void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, mapped->fd, 0);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    mapped->data = data;
+    mapped->size = size;
+    return true;
+}
+
+// Function to open and map a file
+bool mapFile(MappedFile *mapped, const char *path, size_t minSize, bool create)
+{
+    memset(mapped, 0, sizeof(*mapped));
+    mapped->fd = open(path, O_RDWR | (create ? O_CREAT : 0), 0644);
+    if (mapped->fd < 0)
+    {
+        return false;
+    }
+    if (!mapDescriptor(mapped, minSize))
+    {
+        close(mapped->fd);
+        mapped->fd = -1;
+        return false;
+    }
+    return true;
+}
+
+// Function to map a copy-on-write view of a whole file
+bool mapFilePrivate(MappedFile *mapped, const char *path)
+{
+    memset(mapped, 0, sizeof(*mapped));
+    mapped->isPrivate = true;
+    mapped->fd = -1;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    bool ok = fstat(fd, &info) == 0;
+    if (ok && info.st_size > 0)
+    {
+        void *data = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ok = data != MAP_FAILED;
+        if (ok)
+        {
+            mapped->data = data;
+            mapped->size = (size_t)info.st_size;
+        }
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    return ok;
+}
+
+// Function to grow the file (or private copy) and map it again at its new size
+bool resizeMappedFile(MappedFile *mapped, size_t size)
+{
+    if (mapped->isPrivate)
+    {
+        // Growing a private view must not extend the file, so move to anonymous memory
+        void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+        memcpy(data, mapped->data, mapped->size < size ? mapped->size : size);
+        if (mapped->data)
+        {
+            munmap(mapped->data, mapped->size);
+        }
+        mapped->data = data;
+        mapped->size = size;
+        return true;
+    }
+
+    if (mapped->data)
+    {
+        munmap(mapped->data, mapped->size);
+    }
+    mapped->data = NULL;
+    mapped->size = 0;
+    return mapDescriptor(mapped, size);
+}
+
+// Function to write a changed range of the mapping back to disk
+bool syncMappedRange(MappedFile *mapped, size_t offset, size_t length)
+{
+    if (mapped->isPrivate)
+    {
+        return true;
+    }
+
+    // msync needs a page-aligned start address
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = offset - offset % pageSize;
+    return msync((char *)mapped->data + start, length + (offset - start), MS_SYNC) == 0;
+}
+
+// Function to unmap and close the file
+void unmapFile(MappedFile *mapped)
+{
+    if (mapped->data)
+    {
+        munmap(mapped->data, mapped->size);
+    }
+    if (mapped->fd >= 0)
+    {
+        close(mapped->fd);
+    }
+    memset(mapped, 0, sizeof(*mapped));
+    mapped->fd = -1;
+}
+
+// Function to check whether a file exists
+bool fileExists(const char *path)
+{
+    struct stat info;
+    return stat(path, &info) == 0;
+}
+
+// Function to fill in a stamp from a file's status
+static void stampFromInfo(const struct stat *info, FileStamp *stamp)
+{
+    stamp->id = ((uint64_t)info->st_dev << 32) ^ (uint64_t)info->st_ino;
+    stamp->size = (uint64_t)info->st_size;
+    stamp->modified = (int64_t)info->st_mtim.tv_sec * 1000000000 + info->st_mtim.tv_nsec;
+}
+
+// Function to get the stamp of a file; false (and a zeroed stamp) if it is missing
+bool readFileStamp(const char *path, FileStamp *stamp)
+{
+    memset(stamp, 0, sizeof(*stamp));
+    struct stat info;
+    if (stat(path, &info) != 0)
+    {
+        return false;
+    }
+    stampFromInfo(&info, stamp);
+    return true;
+}
+
+// Function to make a rename in the file's directory durable
+static void syncParentDirectory(const char *path)
+{
+    char copy[4096];
+    snprintf(copy, sizeof(copy), "%s", path);
+    int fd = open(dirname(copy), O_RDONLY);
+    if (fd >= 0)
+    {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+// Function to replace a file with new contents so readers see either all of the old file or all of the new one
+bool writeFileAtomically(const char *path, const void *data, size_t size)
+{
+    // The temporary name is per process, so instances replacing the same file never write into each other's copy
+    char tempPath[4096];
+    snprintf(tempPath, sizeof(tempPath), "%s.%ld.tmp", path, (long)getpid());
+    int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool ok = true;
+    for (size_t done = 0; ok && done < size;)
+    {
+        ssize_t written = write(fd, (const char *)data + done, size - done);
+        ok = written > 0;
+        done += ok ? (size_t)written : 0;
+    }
+    ok = ok && fsync(fd) == 0;
+    close(fd);
+    if (!ok || rename(tempPath, path) != 0)
+    {
+        unlink(tempPath);
+        return false;
+    }
+    syncParentDirectory(path);
+    return true;
+}
+
+// Function to cut a file down to size bytes
+bool truncateFile(const char *path, size_t size)
+{
+    return truncate(path, (off_t)size) == 0;
+}
+
+// Function to open (or create) a file that is only ever appended to
+bool openAppendFile(AppendFile *file, const char *path)
+{
+    file->fd = open(path, O_WRONLY | O_APPEND | O_CREAT, 0644);
+    return file->fd >= 0;
+}
+
+// Function to append bytes at the end of the file in one write; endOffset
+// (optional) receives where the write ended, which shows other writers' appends
+bool appendToFile(AppendFile *file, const void *data, size_t size, uint64_t *endOffset)
+{
+    if (write(file->fd, data, size) != (ssize_t)size)
+    {
+        return false;
+    }
+    if (endOffset)
+    {
+        off_t position = lseek(file->fd, 0, SEEK_CUR);
+        if (position < 0)
+        {
+            return false;
+        }
+        *endOffset = (uint64_t)position;
+    }
+    return true;
+}
+
+// Function to make everything appended so far durable
+bool syncAppendFile(AppendFile *file)
+{
+    return fdatasync(file->fd) == 0;
+}
+
+// Function to read the stamp of the file an append-only file has open, which
+// differs from the path's stamp once another process has replaced the file
+bool readAppendFileStamp(const AppendFile *file, FileStamp *stamp)
+{
+    memset(stamp, 0, sizeof(*stamp));
+    struct stat info;
+    if (fstat(file->fd, &info) != 0)
+    {
+        return false;
+    }
+    stampFromInfo(&info, stamp);
+    return true;
+}
+
+// Function to close an append-only file
+void closeAppendFile(AppendFile *file)
+{
+    if (file->fd >= 0)
+    {
+        close(file->fd);
+    }
+    file->fd = -1;
+}
+
+#endif
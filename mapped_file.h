@@ -0,0 +1,68 @@
+// Memory-mapped file helpers
+// Thin wrapper over mmap (POSIX) and file mappings (Windows) used by the
+// score store, so the rest of the code never needs platform #ifdefs. Also
+// holds the other file operations the store needs: atomic replacement,
+// truncation, appends and change stamps
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Structure to store an open file and its mapping
+typedef struct
+{
+    void *data;
+    size_t size;
+    bool isPrivate;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+} MappedFile;
+
+// Structure to store a file opened for appending
+typedef struct
+{
+#ifdef _WIN32
+    HANDLE file;
+#else
+    int fd;
+#endif
+} AppendFile;
+
+// Structure to store what identifies one version of a file: replacing it
+// changes the id, writing to it changes the size or modification time
+typedef struct
+{
+    uint64_t id;
+    uint64_t size;
+    int64_t modified;
+} FileStamp;
+
+// Function prototypes
+bool mapFile(MappedFile *mapped, const char *path, size_t minSize, bool create);
+bool mapFilePrivate(MappedFile *mapped, const char *path);
+bool resizeMappedFile(MappedFile *mapped, size_t size);
+bool syncMappedRange(MappedFile *mapped, size_t offset, size_t length);
+void unmapFile(MappedFile *mapped);
+bool fileExists(const char *path);
+bool readFileStamp(const char *path, FileStamp *stamp);
+bool sameFileStamp(const FileStamp *a, const FileStamp *b);
+bool writeFileAtomically(const char *path, const void *data, size_t size);
+bool truncateFile(const char *path, size_t size);
+bool openAppendFile(AppendFile *file, const char *path);
+bool appendToFile(AppendFile *file, const void *data, size_t size, uint64_t *endOffset);
+bool syncAppendFile(AppendFile *file);
+bool readAppendFileStamp(const AppendFile *file, FileStamp *stamp);
+void closeAppendFile(AppendFile *file);
+
+#endif
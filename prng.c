@@ -0,0 +1,110 @@
+// Seedable random number engine for magic numbers
+// The same seed always produces the same digits, on every platform
+
+#include "prng.h"
+
+// 18 * 10^18 is the largest multiple of 10^18 below 2^64; draws at or above it
+// are rejected so every block of 18 digits is uniform (about 2.4% are redrawn)
+#define DIGIT_BLOCK 1000000000000000000ULL
+#define DIGIT_LIMIT (18 * DIGIT_BLOCK)
+
+// Function to advance a splitmix64 generator, used to expand the seed
+static uint64_t splitMix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Function to rotate a 64-bit value left
+static inline uint64_t rotateLeft(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+// Function to reset the engine to the sequence of the given seed
+void seedRng(DigitRng *rng, uint64_t seed)
+{
+    uint64_t x = seed;
+    for (int i = 0; i < 4; i++)
+    {
+        rng->state[i] = splitMix64(&x);
+    }
+    rng->digitPool = 0;
+    rng->digitsLeft = 0;
+}
+
+// Function to get the next 64-bit output (xoshiro256**)
+uint64_t nextRandom(DigitRng *rng)
+{
+    uint64_t *s = rng->state;
+    uint64_t result = rotateLeft(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotateLeft(s[3], 45);
+    return result;
+}
+
+// Function to draw a uniform value in [0, 10^18), good for 18 digits
+static uint64_t nextDigitBlock(DigitRng *rng)
+{
+    uint64_t r;
+    do
+    {
+        r = nextRandom(rng);
+    } while (r >= DIGIT_LIMIT);
+    return r % DIGIT_BLOCK;
+}
+
+// Function to get one uniform digit (0-9)
+int nextDigit(DigitRng *rng)
+{
+    if (rng->digitsLeft == 0)
+    {
+        rng->digitPool = nextDigitBlock(rng);
+        rng->digitsLeft = RNG_DIGITS_PER_DRAW;
+    }
+    int digit = (int)(rng->digitPool % 10);
+    rng->digitPool /= 10;
+    rng->digitsLeft--;
+    return digit;
+}
+
+// Function to fill digits[0..count) with uniform ASCII digits
+void randomDigits(DigitRng *rng, char *digits, int count)
+{
+    int i = 0;
+
+    // Use up digits left over from the previous call first
+    while (i < count && rng->digitsLeft > 0)
+    {
+        digits[i++] = (char)('0' + nextDigit(rng));
+    }
+
+    // Split each block into two 9-digit halves so the inner loop stays in 32 bits
+    while (count - i >= RNG_DIGITS_PER_DRAW)
+    {
+        uint64_t block = nextDigitBlock(rng);
+        uint32_t halves[2] = {(uint32_t)(block % 1000000000), (uint32_t)(block / 1000000000)};
+        for (int h = 0; h < 2; h++)
+        {
+            uint32_t half = halves[h];
+            for (int d = 0; d < 9; d++)
+            {
+                digits[i++] = (char)('0' + half % 10);
+                half /= 10;
+            }
+        }
+    }
+
+    while (i < count)
+    {
+        digits[i++] = (char)('0' + nextDigit(rng));
+    }
+}
@@ -0,0 +1,27 @@
+// Seedable random number engine for magic numbers
+// xoshiro256** seeded through splitmix64; each 64-bit output is turned into
+// 18 unbiased decimal digits, so long magic numbers are cheap to generate
+
+#ifndef PRNG_H
+#define PRNG_H
+
+#include <stdint.h>
+
+// Decimal digits extracted from every accepted 64-bit output
+#define RNG_DIGITS_PER_DRAW 18
+
+// Structure to store the engine state and the digits not handed out yet
+typedef struct
+{
+    uint64_t state[4];
+    uint64_t digitPool;
+    int digitsLeft;
+} DigitRng;
+
+// Function prototypes
+void seedRng(DigitRng *rng, uint64_t seed);
+uint64_t nextRandom(DigitRng *rng);
+int nextDigit(DigitRng *rng);
+void randomDigits(DigitRng *rng, char *digits, int count);
+
+#endif
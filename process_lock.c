@@ -0,0 +1,96 @@
+// Lock shared between processes
+// Threads of one process share its id, so the lock also keeps them apart,
+// but it is not reentrant and a thread must not take it twice
+
+#include "process_lock.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+// Failed attempts between checks that the holder is still running
+#define LOCK_OWNER_CHECK_SPINS 1024
+
+#ifdef _WIN32
+
+// Function to get the id the lock is held with
+static uint32_t currentProcess()
+{
+    return (uint32_t)GetCurrentProcessId();
+}
+
+// Function to check whether a process is still running
+static bool processRunning(uint32_t id)
+{
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, id);
+    if (process == NULL)
+    {
+        return GetLastError() == ERROR_ACCESS_DENIED;
+    }
+    bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+    return running;
+}
+
+// Function to let other threads run while waiting
+static void yieldThread()
+{
+    SwitchToThread();
+}
+
+#else
+
+// Function to get the id the lock is held with
+static uint32_t currentProcess()
+{
+    return (uint32_t)getpid();
+}
+
+// Function to check whether a process is still running
+static bool processRunning(uint32_t id)
+{
+    return kill((pid_t)id, 0) == 0 || errno != ESRCH;
+}
+
+// Function to let other threads run while waiting
+static void yieldThread()
+{
+    sched_yield();
+}
+
+#endif
+
+// Function to take the lock if it is free, without waiting
+bool tryLockProcesses(uint32_t *lock)
+{
+    uint32_t expected = 0;
+    return __atomic_compare_exchange_n(lock, &expected, currentProcess(), false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+// Function to take the lock, waiting while another process or thread has it
+void lockProcesses(uint32_t *lock)
+{
+    for (int spins = 1; !tryLockProcesses(lock); spins++)
+    {
+        yieldThread();
+
+        // A process that crashed holding the lock never frees it, so its waiters take it over
+        uint32_t owner = __atomic_load_n(lock, __ATOMIC_RELAXED);
+        if (spins % LOCK_OWNER_CHECK_SPINS == 0 && owner != 0 && owner != currentProcess() && !processRunning(owner) &&
+            __atomic_compare_exchange_n(lock, &owner, currentProcess(), false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            return;
+        }
+    }
+}
+
+// Function to let go of the lock
+void unlockProcesses(uint32_t *lock)
+{
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,17 @@
+// Lock shared between processes
+// A 32-bit word in shared memory holding the id of the process that has it,
+// or 0 when it is free. Waiters spin and yield, and take the lock over if
+// the process holding it has exited without letting go
+
+#ifndef PROCESS_LOCK_H
+#define PROCESS_LOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Function prototypes
+void lockProcesses(uint32_t *lock);
+bool tryLockProcesses(uint32_t *lock);
+void unlockProcesses(uint32_t *lock);
+
+#endif
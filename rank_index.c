@@ -0,0 +1,327 @@
+// Rank index for the leaderboard
+// Built in O(n) from the records in ranked order (a Cartesian tree over
+// hashed priorities), then kept current with split/merge on every update.
+// The ranked order comes from a radix sort of the score table's key column
+
+#include "rank_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Function to get a node's pseudo-random heap priority from its slot
+static uint32_t slotPriority(uint64_t slot)
+{
+    uint64_t x = (slot + 1) * 0x9e3779b97f4a7c15ULL;
+    x ^= x >> 32;
+    x *= 0xd6e8feb86659fd93ULL;
+    return (uint32_t)(x >> 32);
+}
+
+// Function to check whether node a ranks before node b
+static bool ranksBefore(const RankIndex *index, uint32_t a, uint32_t b)
+{
+    uint64_t keyA = index->nodes[a].key;
+    uint64_t keyB = index->nodes[b].key;
+    if (keyA != keyB)
+    {
+        return keyA > keyB;
+    }
+    return a < b;
+}
+
+// Function to recompute a node's subtree size from its children
+static void updateSize(RankIndex *index, uint32_t node)
+{
+    RankNode *n = &index->nodes[node];
+    n->size = 1 + index->nodes[n->left].size + index->nodes[n->right].size;
+}
+
+// Function to split a tree into nodes ranking before key and the rest
+static void splitTree(RankIndex *index, uint32_t tree, uint32_t key, uint32_t *before, uint32_t *after)
+{
+    if (tree == 0)
+    {
+        *before = 0;
+        *after = 0;
+        return;
+    }
+    RankNode *n = &index->nodes[tree];
+    if (ranksBefore(index, tree, key))
+    {
+        splitTree(index, n->right, key, &n->right, after);
+        *before = tree;
+    }
+    else
+    {
+        splitTree(index, n->left, key, before, &n->left);
+        *after = tree;
+    }
+    updateSize(index, tree);
+}
+
+// Function to join two trees where every node of a ranks before every node of b
+static uint32_t mergeTrees(RankIndex *index, uint32_t a, uint32_t b)
+{
+    if (a == 0 || b == 0)
+    {
+        return a ? a : b;
+    }
+    if (index->nodes[a].priority > index->nodes[b].priority)
+    {
+        index->nodes[a].right = mergeTrees(index, index->nodes[a].right, b);
+        updateSize(index, a);
+        return a;
+    }
+    index->nodes[b].left = mergeTrees(index, a, index->nodes[b].left);
+    updateSize(index, b);
+    return b;
+}
+
+// Function to remove a node from the subtree it is in, returning the new subtree root
+static uint32_t removeNode(RankIndex *index, uint32_t tree, uint32_t node)
+{
+    if (tree == node)
+    {
+        RankNode *n = &index->nodes[node];
+        uint32_t merged = mergeTrees(index, n->left, n->right);
+        n->left = n->right = n->size = 0;
+        return merged;
+    }
+    RankNode *t = &index->nodes[tree];
+    if (ranksBefore(index, node, tree))
+    {
+        t->left = removeNode(index, t->left, node);
+    }
+    else
+    {
+        t->right = removeNode(index, t->right, node);
+    }
+    updateSize(index, tree);
+    return tree;
+}
+
+// Function to make room for nodes up to the given slot
+static bool reserveNodes(RankIndex *index, uint64_t slot)
+{
+    if (slot + 1 < index->capacity)
+    {
+        return true;
+    }
+    uint64_t capacity = index->capacity > 0 ? index->capacity : 64;
+    while (capacity <= slot + 1)
+    {
+        capacity *= 2;
+    }
+    RankNode *nodes = (RankNode *)realloc(index->nodes, sizeof(RankNode) * capacity);
+    if (nodes == NULL)
+    {
+        return false;
+    }
+    memset(nodes + index->capacity, 0, sizeof(RankNode) * (capacity - index->capacity));
+    index->nodes = nodes;
+    index->capacity = capacity;
+    return true;
+}
+
+// Function to build the index over a key column, where the key at i is the player in slot i
+bool buildRankIndex(RankIndex *index, const uint64_t *scoreKeys, uint64_t count)
+{
+    memset(index, 0, sizeof(*index));
+    if (!reserveNodes(index, count))
+    {
+        return false;
+    }
+
+    // Fill in the nodes and sort their ids into ranked order; node ids start
+    // in slot order and the sort is stable, so equal keys stay in slot order
+    uint32_t *order = (uint32_t *)malloc(sizeof(uint32_t) * (count + 1));
+    uint32_t *stack = (uint32_t *)malloc(sizeof(uint32_t) * (count + 1));
+    uint64_t *keys = (uint64_t *)malloc(sizeof(uint64_t) * (count + 1));
+    if (order == NULL || stack == NULL || keys == NULL)
+    {
+        free(order);
+        free(stack);
+        free(keys);
+        freeRankIndex(index);
+        return false;
+    }
+    for (uint64_t i = 0; i < count; i++)
+    {
+        RankNode *n = &index->nodes[i + 1];
+        n->key = scoreKeys[i];
+        n->priority = slotPriority(i);
+        n->size = 1;
+        keys[i] = n->key;
+        order[i] = (uint32_t)(i + 1);
+    }
+    bool sorted = sortScoreKeysParallel(keys, order, count, processorCount());
+    free(keys);
+    if (!sorted)
+    {
+        free(order);
+        free(stack);
+        freeRankIndex(index);
+        return false;
+    }
+
+    // Cartesian tree: the right spine lives on a stack while nodes arrive in order
+    int top = 0;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        uint32_t node = order[i];
+        uint32_t last = 0;
+        while (top > 0 && index->nodes[stack[top - 1]].priority < index->nodes[node].priority)
+        {
+            last = stack[--top];
+        }
+        index->nodes[node].left = last;
+        if (top > 0)
+        {
+            index->nodes[stack[top - 1]].right = node;
+        }
+        stack[top++] = node;
+    }
+    index->root = top > 0 ? stack[0] : 0;
+
+    // Subtree sizes bottom-up: a post-order walk with an explicit stack
+    top = 0;
+    uint32_t previous = 0;
+    if (index->root)
+    {
+        stack[top++] = index->root;
+    }
+    while (top > 0)
+    {
+        uint32_t node = stack[top - 1];
+        RankNode *n = &index->nodes[node];
+        if (previous == 0 || index->nodes[previous].left == node || index->nodes[previous].right == node)
+        {
+            // Walking down: visit the left child, then the right one
+            if (n->left)
+            {
+                stack[top++] = n->left;
+            }
+            else if (n->right)
+            {
+                stack[top++] = n->right;
+            }
+        }
+        else if (previous == n->left && n->right)
+        {
+            stack[top++] = n->right;
+        }
+        else
+        {
+            updateSize(index, node);
+            top--;
+        }
+        previous = node;
+    }
+
+    free(order);
+    free(stack);
+    return true;
+}
+
+// Function to free the index
+void freeRankIndex(RankIndex *index)
+{
+    free(index->nodes);
+    memset(index, 0, sizeof(*index));
+}
+
+// Function to insert a player, or move them to their new position after their record changed
+bool updateRank(RankIndex *index, uint64_t slot, uint64_t key)
+{
+    if (!reserveNodes(index, slot))
+    {
+        return false;
+    }
+    uint32_t node = (uint32_t)(slot + 1);
+    if (index->nodes[node].size != 0)
+    {
+        index->root = removeNode(index, index->root, node);
+    }
+
+    RankNode *n = &index->nodes[node];
+    n->key = key;
+    n->priority = slotPriority(slot);
+    n->left = n->right = 0;
+    n->size = 1;
+
+    uint32_t before, after;
+    splitTree(index, index->root, node, &before, &after);
+    index->root = mergeTrees(index, mergeTrees(index, before, node), after);
+    return true;
+}
+
+// Function to get a player's 1-based rank, or 0 if the slot is not in the index
+uint64_t rankOfSlot(const RankIndex *index, uint64_t slot)
+{
+    uint32_t node = (uint32_t)(slot + 1);
+    if (slot + 1 >= index->capacity || index->nodes[node].size == 0)
+    {
+        return 0;
+    }
+
+    uint64_t rank = 0;
+    uint32_t tree = index->root;
+    while (tree != 0)
+    {
+        const RankNode *t = &index->nodes[tree];
+        if (tree == node)
+        {
+            return rank + index->nodes[t->left].size + 1;
+        }
+        if (ranksBefore(index, node, tree))
+        {
+            tree = t->left;
+        }
+        else
+        {
+            rank += index->nodes[t->left].size + 1;
+            tree = t->right;
+        }
+    }
+    return 0;
+}
+
+// Function to get the slot of the player at a 1-based rank, or -1 if out of range
+long long slotAtRank(const RankIndex *index, uint64_t rank)
+{
+    uint32_t tree = index->root;
+    while (tree != 0)
+    {
+        const RankNode *t = &index->nodes[tree];
+        uint64_t leftSize = index->nodes[t->left].size;
+        if (rank <= leftSize)
+        {
+            tree = t->left;
+        }
+        else if (rank == leftSize + 1)
+        {
+            return (long long)tree - 1;
+        }
+        else
+        {
+            rank -= leftSize + 1;
+            tree = t->right;
+        }
+    }
+    return -1;
+}
+
+// Function to get the number of players in the index
+uint64_t rankedCount(const RankIndex *index)
+{
+    return index->nodes ? index->nodes[index->root].size : 0;
+}
+
+// Function to get the share of players ranked below the given rank, in percent
+double rankPercentile(uint64_t rank, uint64_t total)
+{
+    if (total == 0 || rank == 0)
+    {
+        return 0.0;
+    }
+    return 100.0 * (double)(total - rank) / (double)total;
+}
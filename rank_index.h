@@ -0,0 +1,41 @@
+// Rank index for the leaderboard
+// An order-statistic treap over every player, ordered by packed score key
+// (best first, see score_key.h), then slot. Each node sits at its record's
+// slot and knows the size of its subtree, so a player's rank, the player at
+// a rank and a percentile are all O(log n)
+
+#ifndef RANK_INDEX_H
+#define RANK_INDEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "score_key.h"
+
+// Structure of one node; node 0 is the empty tree and node slot + 1 is the record at slot
+typedef struct
+{
+    uint64_t key;
+    uint32_t priority;
+    uint32_t left;
+    uint32_t right;
+    uint32_t size;
+} RankNode;
+
+// Structure to store the treap
+typedef struct
+{
+    RankNode *nodes;
+    uint64_t capacity;
+    uint32_t root;
+} RankIndex;
+
+// Function prototypes
+bool buildRankIndex(RankIndex *index, const uint64_t *scoreKeys, uint64_t count);
+void freeRankIndex(RankIndex *index);
+bool updateRank(RankIndex *index, uint64_t slot, uint64_t key);
+uint64_t rankOfSlot(const RankIndex *index, uint64_t slot);
+long long slotAtRank(const RankIndex *index, uint64_t rank);
+uint64_t rankedCount(const RankIndex *index);
+double rankPercentile(uint64_t rank, uint64_t total);
+
+#endif
@@ -0,0 +1,70 @@
+// Redraw scheduler
+// Replaces the fixed SDL_Delay polling loops: an idle screen blocks until an
+// event arrives or its next deadline passes, and repaints right after a keypress
+
+#include "redraw.h"
+
+// Function to start with everything dirty so the first frame is drawn
+void initRedrawScheduler(RedrawScheduler *scheduler)
+{
+    scheduler->dirty = REDRAW_ALL;
+    scheduler->deadline = REDRAW_NO_DEADLINE;
+}
+
+// Function to flag parts of the screen as needing a repaint
+void markRedraw(RedrawScheduler *scheduler, unsigned int flags)
+{
+    scheduler->dirty |= flags;
+}
+
+// Function to set when the timer part of the screen next changes (SDL_GetTicks64 time)
+void setRedrawDeadline(RedrawScheduler *scheduler, Uint64 deadline)
+{
+    scheduler->deadline = deadline;
+}
+
+// Function to wait for the next event, returning false when the wait ended without one
+bool waitRedrawEvent(RedrawScheduler *scheduler, SDL_Event *event)
+{
+    bool gotEvent;
+    if (scheduler->dirty)
+    {
+        // A repaint is pending, so only drain what is already queued
+        gotEvent = SDL_PollEvent(event) != 0;
+    }
+    else if (scheduler->deadline == REDRAW_NO_DEADLINE)
+    {
+        gotEvent = SDL_WaitEvent(event) != 0;
+    }
+    else
+    {
+        Uint64 now = SDL_GetTicks64();
+        int timeout = scheduler->deadline > now ? (int)(scheduler->deadline - now) : 0;
+        gotEvent = SDL_WaitEventTimeout(event, timeout) != 0;
+    }
+
+    if (scheduler->deadline != REDRAW_NO_DEADLINE && SDL_GetTicks64() >= scheduler->deadline)
+    {
+        scheduler->dirty |= REDRAW_TIMER;
+        scheduler->deadline = REDRAW_NO_DEADLINE;
+    }
+
+    // The window contents may be lost after it is exposed, resized or restored
+    if (gotEvent && event->type == SDL_WINDOWEVENT)
+    {
+        scheduler->dirty |= REDRAW_ALL;
+    }
+    return gotEvent;
+}
+
+// Function to check whether any of the given parts need a repaint
+bool needsRedraw(const RedrawScheduler *scheduler, unsigned int flags)
+{
+    return (scheduler->dirty & flags) != 0;
+}
+
+// Function to mark the screen as up to date after a repaint
+void clearRedraw(RedrawScheduler *scheduler)
+{
+    scheduler->dirty = 0;
+}
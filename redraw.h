@@ -0,0 +1,36 @@
+// Redraw scheduler for the game's screens
+// Screens only repaint when something they show has changed, and sleep in
+// SDL_WaitEventTimeout until the next event or the next timed change
+
+#ifndef REDRAW_H
+#define REDRAW_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+// Parts of a screen that can need a repaint
+#define REDRAW_INPUT 0x01
+#define REDRAW_FEEDBACK 0x02
+#define REDRAW_LEVEL 0x04
+#define REDRAW_TIMER 0x08
+#define REDRAW_ALL (REDRAW_INPUT | REDRAW_FEEDBACK | REDRAW_LEVEL | REDRAW_TIMER)
+
+// Deadline value meaning nothing on the screen changes by itself
+#define REDRAW_NO_DEADLINE 0
+
+// Structure to store what needs repainting and when the screen next changes
+typedef struct
+{
+    unsigned int dirty;
+    Uint64 deadline;
+} RedrawScheduler;
+
+// Function prototypes
+void initRedrawScheduler(RedrawScheduler *scheduler);
+void markRedraw(RedrawScheduler *scheduler, unsigned int flags);
+void setRedrawDeadline(RedrawScheduler *scheduler, Uint64 deadline);
+bool waitRedrawEvent(RedrawScheduler *scheduler, SDL_Event *event);
+bool needsRedraw(const RedrawScheduler *scheduler, unsigned int flags);
+void clearRedraw(RedrawScheduler *scheduler);
+
+#endif
@@ -0,0 +1,390 @@
+// Packed score keys and radix sorting
+// Radix sort, 8 bits per pass, best key first. A large table is first split
+// by its highest byte that differs between keys (one pass over memory), then
+// each bucket, now small enough to stay in cache, is sorted least significant
+// byte first. Bytes that are the same in every key (the high bits of the time
+// and sequence fields, usually) are skipped. Every pass keeps the order of
+// equal bytes, so the sort is stable
+
+#include "score_key.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES (64 / RADIX_BITS)
+#define MAX_SORT_THREADS 64
+
+// Ranges up to this many keys are sorted least significant byte first; larger
+// ones are split by their highest byte first
+#define RADIX_CACHE_SORT 32768
+
+// Function to pack a run into its rank key
+uint64_t scoreKey(double successRatio, int time, uint64_t sequence)
+{
+    double hundredths = floor(successRatio * 100.0 + 0.5);
+    uint64_t ratio = hundredths <= 0.0 ? 0 : hundredths >= 10000.0 ? 10000 : (uint64_t)hundredths;
+    uint64_t seconds = time <= 0 ? 0 : (uint64_t)time >= SCORE_KEY_TIME_MAX ? SCORE_KEY_TIME_MAX : (uint64_t)time;
+    uint64_t run = sequence >= SCORE_KEY_SEQUENCE_MAX ? SCORE_KEY_SEQUENCE_MAX : sequence;
+    return (ratio << SCORE_KEY_RATIO_SHIFT) | ((SCORE_KEY_TIME_MAX - seconds) << SCORE_KEY_TIME_SHIFT) | (SCORE_KEY_SEQUENCE_MAX - run);
+}
+
+// Function to get the success ratio a key was packed with, to 2 decimals
+double scoreKeyRatio(uint64_t key)
+{
+    return (double)(key >> SCORE_KEY_RATIO_SHIFT) / 100.0;
+}
+
+// Function to get the bucket of a key in a pass; inverted so the best key comes first
+static inline unsigned radixDigit(uint64_t key, int pass)
+{
+    return (unsigned)((~key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1));
+}
+
+// Function to check whether every key has the same byte in a pass
+static bool passIsTrivial(const uint64_t *histogram, uint64_t count)
+{
+    for (int b = 0; b < RADIX_BUCKETS; b++)
+    {
+        if (histogram[b] != 0)
+        {
+            return histogram[b] == count;
+        }
+    }
+    return true;
+}
+
+// Function to turn bucket counts into the position of each bucket's first key
+static void bucketOffsets(uint64_t *histogram, uint64_t start)
+{
+    for (int b = 0; b < RADIX_BUCKETS; b++)
+    {
+        uint64_t bucketSize = histogram[b];
+        histogram[b] = start;
+        start += bucketSize;
+    }
+}
+
+// Function to move keys and values into their buckets for a pass, in order
+static void scatterPass(const uint64_t *fromKeys, const uint32_t *fromValues, uint64_t *toKeys, uint32_t *toValues,
+                        uint64_t begin, uint64_t end, int pass, uint64_t *positions)
+{
+    for (uint64_t i = begin; i < end; i++)
+    {
+        uint64_t position = positions[radixDigit(fromKeys[i], pass)]++;
+        toKeys[position] = fromKeys[i];
+        toValues[position] = fromValues[i];
+    }
+}
+
+// Function to sort a range by bytes 0..top, least significant first; the
+// scratch range is the same size and the result ends up in keys and values
+static void sortSmallRange(uint64_t *keys, uint32_t *values, uint64_t *keyScratch, uint32_t *valueScratch, uint64_t count, int top)
+{
+    uint64_t histograms[RADIX_PASSES][RADIX_BUCKETS];
+    memset(histograms, 0, sizeof(uint64_t) * RADIX_BUCKETS * (top + 1));
+    for (uint64_t i = 0; i < count; i++)
+    {
+        for (int pass = 0; pass <= top; pass++)
+        {
+            histograms[pass][radixDigit(keys[i], pass)]++;
+        }
+    }
+
+    uint64_t *fromKeys = keys, *toKeys = keyScratch;
+    uint32_t *fromValues = values, *toValues = valueScratch;
+    for (int pass = 0; pass <= top; pass++)
+    {
+        if (passIsTrivial(histograms[pass], count))
+        {
+            continue;
+        }
+        bucketOffsets(histograms[pass], 0);
+        scatterPass(fromKeys, fromValues, toKeys, toValues, 0, count, pass, histograms[pass]);
+
+        uint64_t *swapKeys = fromKeys;
+        fromKeys = toKeys;
+        toKeys = swapKeys;
+        uint32_t *swapValues = fromValues;
+        fromValues = toValues;
+        toValues = swapValues;
+    }
+    if (fromKeys != keys)
+    {
+        memcpy(keys, fromKeys, sizeof(uint64_t) * count);
+        memcpy(values, fromValues, sizeof(uint32_t) * count);
+    }
+}
+
+// Function to sort a range by bytes 0..top; a large range is split by byte
+// top into the scratch range, each bucket is sorted there, and the result is
+// copied back, so it always ends up in keys and values
+static void sortRange(uint64_t *keys, uint32_t *values, uint64_t *keyScratch, uint32_t *valueScratch, uint64_t count, int top)
+{
+    if (count < 2 || top < 0)
+    {
+        return;
+    }
+    if (count <= RADIX_CACHE_SORT)
+    {
+        sortSmallRange(keys, values, keyScratch, valueScratch, count, top);
+        return;
+    }
+
+    uint64_t positions[RADIX_BUCKETS];
+    memset(positions, 0, sizeof(positions));
+    for (uint64_t i = 0; i < count; i++)
+    {
+        positions[radixDigit(keys[i], top)]++;
+    }
+    if (passIsTrivial(positions, count))
+    {
+        sortRange(keys, values, keyScratch, valueScratch, count, top - 1);
+        return;
+    }
+
+    uint64_t starts[RADIX_BUCKETS + 1];
+    bucketOffsets(positions, 0);
+    memcpy(starts, positions, sizeof(positions));
+    starts[RADIX_BUCKETS] = count;
+    scatterPass(keys, values, keyScratch, valueScratch, 0, count, top, positions);
+    for (int b = 0; b < RADIX_BUCKETS; b++)
+    {
+        uint64_t start = starts[b];
+        sortRange(keyScratch + start, valueScratch + start, keys + start, values + start, starts[b + 1] - start, top - 1);
+    }
+    memcpy(keys, keyScratch, sizeof(uint64_t) * count);
+    memcpy(values, valueScratch, sizeof(uint32_t) * count);
+}
+
+// Function to find the highest byte that is not the same in every key, or -1
+static int highestPass(uint64_t histograms[RADIX_PASSES][RADIX_BUCKETS], uint64_t count)
+{
+    for (int pass = RADIX_PASSES - 1; pass >= 0; pass--)
+    {
+        if (!passIsTrivial(histograms[pass], count))
+        {
+            return pass;
+        }
+    }
+    return -1;
+}
+
+// Function to sort keys best first, moving each key's value along with it
+bool sortScoreKeys(uint64_t *keys, uint32_t *values, uint64_t count)
+{
+    if (count < 2)
+    {
+        return true;
+    }
+    uint64_t *keyScratch = (uint64_t *)malloc(sizeof(uint64_t) * count);
+    uint32_t *valueScratch = (uint32_t *)malloc(sizeof(uint32_t) * count);
+    if (keyScratch == NULL || valueScratch == NULL)
+    {
+        free(keyScratch);
+        free(valueScratch);
+        return false;
+    }
+    sortRange(keys, values, keyScratch, valueScratch, count, RADIX_PASSES - 1);
+    free(keyScratch);
+    free(valueScratch);
+    return true;
+}
+
+// Structure to store one thread's share of a parallel sort
+typedef struct
+{
+    uint64_t begin;
+    uint64_t end;
+    uint64_t histogram[RADIX_PASSES][RADIX_BUCKETS];
+} SortChunk;
+
+// Structure to store the state all threads of a parallel sort share
+typedef struct
+{
+    uint64_t *keys;
+    uint32_t *values;
+    uint64_t *keyScratch;
+    uint32_t *valueScratch;
+    SortChunk *chunks;
+    int top;
+    int step;
+    uint64_t starts[RADIX_BUCKETS + 1];
+    int nextBucket;
+} SortJob;
+
+// Steps of a parallel sort, each run by every thread at once
+#define SORT_STEP_COUNT 0
+#define SORT_STEP_SPLIT 1
+#define SORT_STEP_BUCKETS 2
+
+// Structure to store the argument of one sort thread
+typedef struct
+{
+    SortJob *job;
+    int chunk;
+} SortTask;
+
+// Function to do one thread's part of a step: count its chunk's bytes, move
+// its chunk into the top byte's buckets, or sort buckets until none are left
+static void *sortThread(void *context)
+{
+    SortTask *task = (SortTask *)context;
+    SortJob *job = task->job;
+    SortChunk *chunk = &job->chunks[task->chunk];
+    if (job->step == SORT_STEP_COUNT)
+    {
+        for (uint64_t i = chunk->begin; i < chunk->end; i++)
+        {
+            for (int pass = 0; pass < RADIX_PASSES; pass++)
+            {
+                chunk->histogram[pass][radixDigit(job->keys[i], pass)]++;
+            }
+        }
+    }
+    else if (job->step == SORT_STEP_SPLIT)
+    {
+        scatterPass(job->keys, job->values, job->keyScratch, job->valueScratch, chunk->begin, chunk->end, job->top, chunk->histogram[job->top]);
+    }
+    else
+    {
+        // Buckets differ in size, so threads take the next one as they finish
+        int b;
+        while ((b = __atomic_fetch_add(&job->nextBucket, 1, __ATOMIC_RELAXED)) < RADIX_BUCKETS)
+        {
+            uint64_t start = job->starts[b];
+            uint64_t size = job->starts[b + 1] - start;
+            sortRange(job->keyScratch + start, job->valueScratch + start, job->keys + start, job->values + start, size, job->top - 1);
+            memcpy(job->keys + start, job->keyScratch + start, sizeof(uint64_t) * size);
+            memcpy(job->values + start, job->valueScratch + start, sizeof(uint32_t) * size);
+        }
+    }
+    return NULL;
+}
+
+// Function to run one step of a parallel sort on every chunk, the first on this thread
+static void runSortStep(SortJob *job, int step, int threads)
+{
+    SortTask tasks[MAX_SORT_THREADS];
+    pthread_t handles[MAX_SORT_THREADS];
+    bool started[MAX_SORT_THREADS];
+    job->step = step;
+    for (int t = 0; t < threads; t++)
+    {
+        tasks[t].job = job;
+        tasks[t].chunk = t;
+        started[t] = t > 0 && pthread_create(&handles[t], NULL, sortThread, &tasks[t]) == 0;
+    }
+
+    // Chunks whose thread could not start are done here instead
+    for (int t = 0; t < threads; t++)
+    {
+        if (!started[t])
+        {
+            sortThread(&tasks[t]);
+        }
+    }
+    for (int t = 1; t < threads; t++)
+    {
+        if (started[t])
+        {
+            pthread_join(handles[t], NULL);
+        }
+    }
+}
+
+// Function to sort keys best first like sortScoreKeys(), on several threads:
+// the threads count and split their own chunks (each chunk moves into its own
+// part of every bucket, chunks in input order, so the sort stays stable),
+// then sort whole buckets independently. The result is identical
+bool sortScoreKeysParallel(uint64_t *keys, uint32_t *values, uint64_t count, int threads)
+{
+    if (threads > MAX_SORT_THREADS)
+    {
+        threads = MAX_SORT_THREADS;
+    }
+    if (threads < 2 || count < SCORE_SORT_PARALLEL_MIN)
+    {
+        return sortScoreKeys(keys, values, count);
+    }
+
+    SortJob job;
+    memset(&job, 0, sizeof(job));
+    job.keys = keys;
+    job.values = values;
+    job.keyScratch = (uint64_t *)malloc(sizeof(uint64_t) * count);
+    job.valueScratch = (uint32_t *)malloc(sizeof(uint32_t) * count);
+    job.chunks = (SortChunk *)calloc(threads, sizeof(SortChunk));
+    if (job.keyScratch == NULL || job.valueScratch == NULL || job.chunks == NULL)
+    {
+        free(job.keyScratch);
+        free(job.valueScratch);
+        free(job.chunks);
+        return false;
+    }
+    for (int t = 0; t < threads; t++)
+    {
+        job.chunks[t].begin = count * t / threads;
+        job.chunks[t].end = count * (t + 1) / threads;
+    }
+    runSortStep(&job, SORT_STEP_COUNT, threads);
+
+    // The whole table's counts pick the byte to split on
+    uint64_t total[RADIX_PASSES][RADIX_BUCKETS];
+    memset(total, 0, sizeof(total));
+    for (int t = 0; t < threads; t++)
+    {
+        for (int pass = 0; pass < RADIX_PASSES; pass++)
+        {
+            for (int b = 0; b < RADIX_BUCKETS; b++)
+            {
+                total[pass][b] += job.chunks[t].histogram[pass][b];
+            }
+        }
+    }
+    job.top = highestPass(total, count);
+    if (job.top >= 0)
+    {
+        // A bucket's keys come from chunk 0 first, then chunk 1, and so on
+        uint64_t offset = 0;
+        for (int b = 0; b < RADIX_BUCKETS; b++)
+        {
+            job.starts[b] = offset;
+            for (int t = 0; t < threads; t++)
+            {
+                uint64_t chunkSize = job.chunks[t].histogram[job.top][b];
+                job.chunks[t].histogram[job.top][b] = offset;
+                offset += chunkSize;
+            }
+        }
+        job.starts[RADIX_BUCKETS] = count;
+        runSortStep(&job, SORT_STEP_SPLIT, threads);
+        runSortStep(&job, SORT_STEP_BUCKETS, threads);
+    }
+
+    free(job.keyScratch);
+    free(job.valueScratch);
+    free(job.chunks);
+    return true;
+}
+
+// Function to get the number of processors to sort with
+int processorCount()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
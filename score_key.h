@@ -0,0 +1,33 @@
+// Packed score keys and radix sorting
+// A run's rank order packed into one 64-bit integer, so comparing two runs
+// is one integer compare and sorting them is a radix sort over plain keys:
+//
+//   bits 63..50  success ratio in hundredths of a percent (0..10000)
+//   bits 49..32  inverse time: SCORE_KEY_TIME_MAX - seconds
+//   bits 31..0   inverse sequence: SCORE_KEY_SEQUENCE_MAX - sequence
+//
+// A larger key ranks higher: the better ratio (as shown, to 2 decimals),
+// then the faster time, then the earlier run
+
+#ifndef SCORE_KEY_H
+#define SCORE_KEY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SCORE_KEY_RATIO_SHIFT 50
+#define SCORE_KEY_TIME_SHIFT 32
+#define SCORE_KEY_TIME_MAX 0x3ffffULL
+#define SCORE_KEY_SEQUENCE_MAX 0xffffffffULL
+
+// Tables at least this large are sorted with one thread per processor
+#define SCORE_SORT_PARALLEL_MIN (1 << 20)
+
+// Function prototypes
+uint64_t scoreKey(double successRatio, int time, uint64_t sequence);
+double scoreKeyRatio(uint64_t key);
+bool sortScoreKeys(uint64_t *keys, uint32_t *values, uint64_t count);
+bool sortScoreKeysParallel(uint64_t *keys, uint32_t *values, uint64_t count, int threads);
+int processorCount();
+
+#endif
@@ -0,0 +1,773 @@
+// Binary high score store
+// The header checksum is the XOR of a hash of every record, so replacing one
+// record only needs the old and new record hashes, not a pass over the file.
+// The hash index keeps its own XOR checksum the same way; an index that fails
+// it is rebuilt from the records instead of refusing the file.
+//
+// Saving a run appends a journal entry and updates the in-memory copy of the
+// snapshot. Compaction copies that image, writes it to a temporary file on a
+// background thread and renames it over the snapshot; the journal is then cut
+// down to the entries saved after the copy. Replaying an entry only changes
+// a record it improves, so recovery after a crash at any point, or reading
+// runs other processes appended, can go over entries already applied safely.
+// Processes sharing the files can share a writers' lock too: appends and
+// compactions then take turns, and a compaction holds it until the journal
+// is cut, so no run lands in a journal that is about to be replaced
+
+#include "score_store.h"
+#include "score_key.h"
+#include "process_lock.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Index entries hold (32-bit hash tag << 32) | (record slot + 1); 0 is an empty entry
+#define INDEX_EMPTY 0
+#define INDEX_SLOT_MASK 0xffffffffULL
+
+// Function to get the file size needed for a given number of record slots
+static size_t storeFileSize(uint64_t capacity)
+{
+    return sizeof(ScoreStoreHeader) + (size_t)capacity * sizeof(ScoreRecord) + (size_t)capacity * 2 * sizeof(uint64_t);
+}
+
+// Function to point the header, records and index at the current mapping
+static void attachMapping(ScoreStore *store)
+{
+    store->header = (ScoreStoreHeader *)store->file.data;
+    store->records = (ScoreRecord *)((char *)store->file.data + sizeof(ScoreStoreHeader));
+    store->index = (uint64_t *)(store->records + store->header->capacity);
+}
+
+// Function to finish a 64-bit hash so every input bit affects every output bit
+static uint64_t mixHash(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    return hash ^ (hash >> 33);
+}
+
+// Function to hash bytes with FNV-1a starting from a seed
+static uint64_t hashBytes(const void *data, size_t length, uint64_t seed)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    uint64_t hash = 0xcbf29ce484222325ULL ^ seed;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return mixHash(hash);
+}
+
+// Function to hash a record together with its slot
+static uint64_t recordHash(const ScoreRecord *record, uint64_t slot)
+{
+    return hashBytes(record, sizeof(ScoreRecord), slot * 0x9e3779b97f4a7c15ULL);
+}
+
+// Function to hash an index entry together with its position
+static uint64_t indexEntryHash(uint64_t position, uint64_t entry)
+{
+    return mixHash(entry ^ (position * 0x9e3779b97f4a7c15ULL));
+}
+
+// Function to get the checksum of a journal entry
+static uint32_t journalChecksum(const JournalEntry *entry)
+{
+    return (uint32_t)hashBytes(&entry->sequence, sizeof(JournalEntry) - offsetof(JournalEntry, sequence), SCORE_JOURNAL_MAGIC);
+}
+
+// Function to get the name key used by the index: the username as it is
+// stored, truncated to SCORE_NAME_SIZE - 1 bytes and padded with zeros
+void normalizeUsername(char normalized[SCORE_NAME_SIZE], const char *username)
+{
+    memset(normalized, 0, SCORE_NAME_SIZE);
+    strncpy(normalized, username, SCORE_NAME_SIZE - 1);
+}
+
+// Function to put a record slot into the index under the given name hash
+static void insertIndexEntry(ScoreStore *store, uint64_t hash, uint64_t slot)
+{
+    uint64_t mask = store->header->indexCapacity - 1;
+    uint64_t position = hash & mask;
+    while (store->index[position] != INDEX_EMPTY)
+    {
+        position = (position + 1) & mask;
+    }
+    uint64_t entry = (hash & ~INDEX_SLOT_MASK) | (slot + 1);
+    store->index[position] = entry;
+    store->header->indexChecksum ^= indexEntryHash(position, entry);
+}
+
+// Function to rebuild the whole index from the records
+static void rebuildIndex(ScoreStore *store)
+{
+    memset(store->index, 0, (size_t)store->header->indexCapacity * sizeof(uint64_t));
+    store->header->indexChecksum = 0;
+    for (uint64_t i = 0; i < store->header->count; i++)
+    {
+        insertIndexEntry(store, hashBytes(store->records[i].username, SCORE_NAME_SIZE, 0), i);
+    }
+}
+
+// Function to check the index checksum against every index entry
+static bool verifyIndex(const ScoreStore *store)
+{
+    uint64_t checksum = 0;
+    for (uint64_t i = 0; i < store->header->indexCapacity; i++)
+    {
+        if (store->index[i] != INDEX_EMPTY)
+        {
+            checksum ^= indexEntryHash(i, store->index[i]);
+        }
+    }
+    return checksum == store->header->indexChecksum;
+}
+
+// Function to write an empty snapshot for a new store
+static bool createSnapshot(const char *path)
+{
+    size_t size = storeFileSize(SCORE_STORE_INITIAL_CAPACITY);
+    ScoreStoreHeader *header = (ScoreStoreHeader *)calloc(1, size);
+    if (header == NULL)
+    {
+        return false;
+    }
+    header->magic = SCORE_STORE_MAGIC;
+    header->version = SCORE_STORE_VERSION;
+    header->recordSize = sizeof(ScoreRecord);
+    header->capacity = SCORE_STORE_INITIAL_CAPACITY;
+    header->indexCapacity = SCORE_STORE_INITIAL_CAPACITY * 2;
+    header->nextSequence = 1;
+    bool ok = writeFileAtomically(path, header, size);
+    free(header);
+    return ok;
+}
+
+// Function to add the hash index to a version 1 snapshot, which has no index after its records
+static bool upgradeVersion1(ScoreStore *store)
+{
+    uint64_t capacity = store->header->capacity;
+    if (store->file.size < sizeof(ScoreStoreHeader) + (size_t)capacity * sizeof(ScoreRecord) || !resizeMappedFile(&store->file, storeFileSize(capacity)))
+    {
+        return false;
+    }
+    attachMapping(store);
+    store->header->indexCapacity = capacity * 2;
+    store->header->version = SCORE_STORE_VERSION;
+    rebuildIndex(store);
+    return true;
+}
+
+// Function to map the snapshot and check it, returning false if it cannot be used
+static bool loadSnapshot(ScoreStore *store, bool *upgraded)
+{
+    if (!readFileStamp(store->path, &store->snapshotStamp) || !mapFilePrivate(&store->file, store->path) || store->file.size < sizeof(ScoreStoreHeader))
+    {
+        return false;
+    }
+
+    // Refuse files written by another program or that fail their checksum
+    ScoreStoreHeader *header = (ScoreStoreHeader *)store->file.data;
+    bool valid = header->magic == SCORE_STORE_MAGIC && header->recordSize == sizeof(ScoreRecord) && header->count <= header->capacity &&
+                 header->capacity > 0 && (header->capacity & (header->capacity - 1)) == 0;
+    if (valid && header->version == 1)
+    {
+        store->header = header;
+        store->records = (ScoreRecord *)(header + 1);
+        valid = verifyScoreStore(store) && upgradeVersion1(store);
+        *upgraded = valid;
+    }
+    else if (valid)
+    {
+        valid = header->version == SCORE_STORE_VERSION && header->indexCapacity == header->capacity * 2 && store->file.size >= storeFileSize(header->capacity);
+        if (valid)
+        {
+            attachMapping(store);
+            valid = verifyScoreStore(store);
+        }
+    }
+    if (!valid)
+    {
+        return false;
+    }
+
+    // The index is derived data, so a damaged one is rebuilt
+    if (!verifyIndex(store))
+    {
+        rebuildIndex(store);
+    }
+    return true;
+}
+
+// Function to look a normalized name up in the index, returning its slot or -1
+static long long lookupName(const ScoreStore *store, const char normalized[SCORE_NAME_SIZE], uint64_t hash)
+{
+    uint64_t mask = store->header->indexCapacity - 1;
+    uint64_t tag = hash & ~INDEX_SLOT_MASK;
+    for (uint64_t position = hash & mask;; position = (position + 1) & mask)
+    {
+        uint64_t entry = store->index[position];
+        if (entry == INDEX_EMPTY)
+        {
+            return -1;
+        }
+        uint64_t slot = (entry & INDEX_SLOT_MASK) - 1;
+        if ((entry & ~INDEX_SLOT_MASK) == tag && memcmp(store->records[slot].username, normalized, SCORE_NAME_SIZE) == 0)
+        {
+            return (long long)slot;
+        }
+    }
+}
+
+// Function to double the number of record slots; the index moves after the new slots
+static bool growStore(ScoreStore *store)
+{
+    uint64_t capacity = store->header->capacity * 2;
+    if (!resizeMappedFile(&store->file, storeFileSize(capacity)))
+    {
+        return false;
+    }
+    store->header = (ScoreStoreHeader *)store->file.data;
+    store->header->capacity = capacity;
+    store->header->indexCapacity = capacity * 2;
+    attachMapping(store);
+    rebuildIndex(store);
+    return true;
+}
+
+// Function to write a run into the in-memory records; slot is -1 for a new player
+static bool applyRun(ScoreStore *store, long long found, const char normalized[SCORE_NAME_SIZE], uint64_t hash, int time, double successRatio,
+                     uint64_t sequence, uint64_t *slotOut)
+{
+    uint64_t slot;
+    if (found >= 0)
+    {
+        slot = (uint64_t)found;
+        store->header->checksum ^= recordHash(&store->records[slot], slot);
+    }
+    else
+    {
+        if (store->header->count == store->header->capacity && !growStore(store))
+        {
+            return false;
+        }
+        slot = store->header->count++;
+        insertIndexEntry(store, hash, slot);
+    }
+
+    ScoreRecord *record = &store->records[slot];
+    memset(record, 0, sizeof(*record));
+    memcpy(record->username, normalized, SCORE_NAME_SIZE);
+    record->time = time;
+    record->successRatio = successRatio;
+    record->sequence = sequence;
+    store->header->checksum ^= recordHash(record, slot);
+    if (sequence >= store->header->nextSequence)
+    {
+        store->header->nextSequence = sequence + 1;
+    }
+    if (slotOut)
+    {
+        *slotOut = slot;
+    }
+    return true;
+}
+
+// Function to check whether a run ranks above a player's record, by packed
+// score key: a better ratio (to 2 decimals), then a faster time
+static bool improvesRecord(const ScoreRecord *record, double successRatio, int time, uint64_t sequence)
+{
+    return scoreKey(successRatio, time, sequence) > scoreKey(record->successRatio, record->time, record->sequence);
+}
+
+// Function to apply the journal entries from the current read position until
+// the end or the first incomplete or damaged entry; returns the bytes applied.
+// An entry only counts if it is a player's first run or improves on their
+// record, so entries the snapshot already contains are skipped whoever wrote them
+static uint64_t applyJournalEntries(ScoreStore *store, FILE *file, ScoreVisitor changed, void *context, bool *clean)
+{
+    JournalEntry entry;
+    uint64_t bytes = 0;
+    size_t got;
+    while ((got = fread(&entry, 1, sizeof(entry), file)) == sizeof(entry))
+    {
+        if (entry.magic != SCORE_JOURNAL_MAGIC || entry.checksum != journalChecksum(&entry))
+        {
+            break;
+        }
+        uint64_t hash = hashBytes(entry.username, SCORE_NAME_SIZE, 0);
+        long long found = lookupName(store, entry.username, hash);
+        uint64_t slot;
+        if ((found < 0 || improvesRecord(&store->records[found], entry.successRatio, entry.time, entry.sequence)) &&
+            applyRun(store, found, entry.username, hash, entry.time, entry.successRatio, entry.sequence, &slot) && changed)
+        {
+            changed(&store->records[slot], slot, context);
+        }
+        bytes += sizeof(entry);
+    }
+    *clean = got == 0 && feof(file);
+    return bytes;
+}
+
+// Function to replay the journal entries the snapshot does not contain yet,
+// cutting off a torn entry left by a crash in the middle of an append
+static void replayJournal(ScoreStore *store)
+{
+    FILE *file = fopen(store->journalPath, "rb");
+    if (file == NULL)
+    {
+        return;
+    }
+
+    bool clean;
+    uint64_t validBytes = applyJournalEntries(store, file, NULL, NULL, &clean);
+    fclose(file);
+
+    if (!clean)
+    {
+        printf("Score journal %s has a torn tail, dropping it\n", store->journalPath);
+        truncateFile(store->journalPath, (size_t)validBytes);
+    }
+    store->journalBytes = validBytes;
+    store->journalEntries = validBytes / sizeof(JournalEntry);
+}
+
+// Function to open the store, creating it (and migrating legacyPath) if missing
+bool openScoreStore(ScoreStore *store, const char *path, const char *legacyPath)
+{
+    memset(store, 0, sizeof(*store));
+    pthread_mutex_init(&store->journalLock, NULL);
+    store->syncWrites = true;
+    snprintf(store->path, sizeof(store->path), "%s", path);
+    snprintf(store->journalPath, sizeof(store->journalPath), "%s%s", path, SCORE_JOURNAL_SUFFIX);
+
+    bool created = !fileExists(path);
+    if (created && !createSnapshot(path))
+    {
+        printf("Score store %s could not be created!\n", path);
+        pthread_mutex_destroy(&store->journalLock);
+        return false;
+    }
+
+    bool upgraded = false;
+    if (!loadSnapshot(store, &upgraded))
+    {
+        printf("Score store %s is corrupt or from another version!\n", path);
+        unmapFile(&store->file);
+        pthread_mutex_destroy(&store->journalLock);
+        store->header = NULL;
+        return false;
+    }
+    replayJournal(store);
+    if (!openAppendFile(&store->journal, store->journalPath))
+    {
+        printf("Score journal %s could not be opened!\n", store->journalPath);
+        closeScoreStore(store);
+        return false;
+    }
+
+    // One-shot migration from the old tab-separated text file
+    if (created && legacyPath != NULL && fileExists(legacyPath))
+    {
+        importTextScores(store, legacyPath);
+        compactScoreStore(store, true);
+    }
+    else if (upgraded)
+    {
+        compactScoreStore(store, true);
+    }
+    return true;
+}
+
+// Function to cut the journal down to the entries appended after the
+// snapshot image was taken; appends wait meanwhile
+static void trimJournal(ScoreStore *store, uint64_t journalOffset)
+{
+    // Read the tail, then swap it in for the whole journal
+    pthread_mutex_lock(&store->journalLock);
+    FileStamp journalStamp;
+    readFileStamp(store->journalPath, &journalStamp);
+    size_t tailSize = journalStamp.size > journalOffset ? (size_t)(journalStamp.size - journalOffset) : 0;
+    char *tail = (char *)malloc(tailSize > 0 ? tailSize : 1);
+    FILE *file = tail ? fopen(store->journalPath, "rb") : NULL;
+    bool ok = file != NULL && fseek(file, (long)journalOffset, SEEK_SET) == 0 && fread(tail, 1, tailSize, file) == tailSize;
+    if (file)
+    {
+        fclose(file);
+    }
+    if (ok)
+    {
+        closeAppendFile(&store->journal);
+        if (writeFileAtomically(store->journalPath, tail, tailSize))
+        {
+            store->journalBytes -= journalOffset;
+            __atomic_store_n(&store->journalEntries, (uint64_t)(tailSize / sizeof(JournalEntry)), __ATOMIC_RELAXED);
+        }
+        openAppendFile(&store->journal, store->journalPath);
+    }
+    pthread_mutex_unlock(&store->journalLock);
+    free(tail);
+}
+
+// Function to write the snapshot image and cut the journal on the compaction
+// thread, then let other instances write again
+static void *compactionThread(void *context)
+{
+    ScoreStore *store = (ScoreStore *)context;
+    ScoreCompaction *compaction = &store->compaction;
+    compaction->succeeded = writeFileAtomically(store->path, compaction->image, compaction->imageSize);
+    free(compaction->image);
+    compaction->image = NULL;
+    if (compaction->succeeded)
+    {
+        // Our own rename must not look like another process replacing the snapshot
+        readFileStamp(store->path, &compaction->snapshotStamp);
+        trimJournal(store, compaction->journalOffset);
+    }
+    if (store->writerLock)
+    {
+        unlockProcesses(store->writerLock);
+    }
+    __atomic_store_n(&compaction->state, COMPACTION_DONE, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// Function to finish a compaction whose thread has swapped the snapshot and journal
+static void finishCompaction(ScoreStore *store)
+{
+    ScoreCompaction *compaction = &store->compaction;
+    pthread_join(compaction->thread, NULL);
+    compaction->state = COMPACTION_IDLE;
+    if (!compaction->succeeded)
+    {
+        printf("Score store %s could not be compacted!\n", store->path);
+        return;
+    }
+    store->snapshotStamp = compaction->snapshotStamp;
+}
+
+// Function to check whether the records in memory hold every run in the
+// files, which a snapshot written from them has to
+static bool storeUpToDate(ScoreStore *store)
+{
+    FileStamp stamp;
+    if (!readFileStamp(store->path, &stamp) || !sameFileStamp(&stamp, &store->snapshotStamp))
+    {
+        return false;
+    }
+    pthread_mutex_lock(&store->journalLock);
+    bool upToDate = readFileStamp(store->journalPath, &stamp) && stamp.size == store->journalBytes;
+    pthread_mutex_unlock(&store->journalLock);
+    return upToDate;
+}
+
+// Function to write the current records as a new snapshot in the background;
+// with wait set, returns once the snapshot and journal have been swapped.
+// Returns false without compacting if runs other processes saved have not
+// been read yet, or (without wait) another instance is writing
+bool compactScoreStore(ScoreStore *store, bool wait)
+{
+    // A compaction already running has an older image, so waiting starts a new one after it
+    ScoreCompaction *compaction = &store->compaction;
+    int state = __atomic_load_n(&compaction->state, __ATOMIC_ACQUIRE);
+    if (state == COMPACTION_DONE || (state == COMPACTION_RUNNING && wait))
+    {
+        finishCompaction(store);
+    }
+
+    if (compaction->state == COMPACTION_IDLE)
+    {
+        // Instances sharing the files compact one at a time, and hold the writers'
+        // lock until the journal is cut so no run goes into a journal being replaced
+        if (store->writerLock)
+        {
+            if (wait)
+            {
+                lockProcesses(store->writerLock);
+            }
+            else if (!tryLockProcesses(store->writerLock))
+            {
+                return false;
+            }
+        }
+
+        // Take a copy of the image so saving can go on while it is written
+        size_t size = storeFileSize(store->header->capacity);
+        compaction->image = storeUpToDate(store) ? malloc(size) : NULL;
+        if (compaction->image == NULL)
+        {
+            if (store->writerLock)
+            {
+                unlockProcesses(store->writerLock);
+            }
+            return false;
+        }
+        memcpy(compaction->image, store->file.data, size);
+        compaction->imageSize = size;
+        pthread_mutex_lock(&store->journalLock);
+        compaction->journalOffset = store->journalBytes;
+        pthread_mutex_unlock(&store->journalLock);
+        compaction->state = COMPACTION_RUNNING;
+        if (pthread_create(&compaction->thread, NULL, compactionThread, store) != 0)
+        {
+            compaction->state = COMPACTION_IDLE;
+            free(compaction->image);
+            compaction->image = NULL;
+            if (store->writerLock)
+            {
+                unlockProcesses(store->writerLock);
+            }
+            return false;
+        }
+    }
+
+    if (wait)
+    {
+        finishCompaction(store);
+        return compaction->succeeded;
+    }
+    return true;
+}
+
+// Function to apply the runs other processes appended to the journal since
+// the last read, calling changed (optional) for every record that improved.
+// Returns false if the snapshot or journal was replaced and the store has to
+// be reopened; reading stops quietly at an entry another writer is still appending
+bool refreshScoreStore(ScoreStore *store, ScoreVisitor changed, void *context)
+{
+    int state = __atomic_load_n(&store->compaction.state, __ATOMIC_ACQUIRE);
+    if (state == COMPACTION_DONE)
+    {
+        finishCompaction(store);
+    }
+
+    // While our own compaction is running the snapshot is expected to change
+    FileStamp stamp;
+    if (state != COMPACTION_RUNNING && (!readFileStamp(store->path, &stamp) || !sameFileStamp(&stamp, &store->snapshotStamp)))
+    {
+        return false;
+    }
+    pthread_mutex_lock(&store->journalLock);
+    bool ok = readFileStamp(store->journalPath, &stamp) && stamp.size >= store->journalBytes;
+    if (ok && stamp.size - store->journalBytes >= sizeof(JournalEntry))
+    {
+        FILE *file = fopen(store->journalPath, "rb");
+        ok = file != NULL && fseek(file, (long)store->journalBytes, SEEK_SET) == 0;
+        if (ok)
+        {
+            bool clean;
+            store->journalBytes += applyJournalEntries(store, file, changed, context, &clean);
+        }
+        if (file)
+        {
+            fclose(file);
+        }
+    }
+    pthread_mutex_unlock(&store->journalLock);
+    return ok;
+}
+
+// Function to close the store, waiting for a compaction in progress
+void closeScoreStore(ScoreStore *store)
+{
+    if (store->compaction.state != COMPACTION_IDLE)
+    {
+        finishCompaction(store);
+    }
+    closeAppendFile(&store->journal);
+    pthread_mutex_destroy(&store->journalLock);
+    unmapFile(&store->file);
+    store->header = NULL;
+    store->records = NULL;
+    store->index = NULL;
+}
+
+// Function to find the slot of a player's record, or -1 if there is none
+long long findScore(const ScoreStore *store, const char *username)
+{
+    if (store->header == NULL)
+    {
+        return -1;
+    }
+    char normalized[SCORE_NAME_SIZE];
+    normalizeUsername(normalized, username);
+    return lookupName(store, normalized, hashBytes(normalized, SCORE_NAME_SIZE, 0));
+}
+
+// Function to build the journal entry for a player's run; false (with slotOut,
+// if given, set to their slot) when the run does not beat the player's record
+bool prepareScore(ScoreStore *store, const char *username, int time, double successRatio, JournalEntry *entry, uint64_t *slotOut)
+{
+    char normalized[SCORE_NAME_SIZE];
+    normalizeUsername(normalized, username);
+
+    // Keep only the better run
+    long long found = lookupName(store, normalized, hashBytes(normalized, SCORE_NAME_SIZE, 0));
+    if (found >= 0)
+    {
+        if (slotOut)
+        {
+            *slotOut = (uint64_t)found;
+        }
+        if (!improvesRecord(&store->records[found], successRatio, time, store->header->nextSequence))
+        {
+            return false;
+        }
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    entry->magic = SCORE_JOURNAL_MAGIC;
+    entry->sequence = store->header->nextSequence;
+    memcpy(entry->username, normalized, SCORE_NAME_SIZE);
+    entry->time = time;
+    entry->successRatio = successRatio;
+    entry->checksum = journalChecksum(entry);
+    return true;
+}
+
+// Function to append prepared entries to the journal with one write (and one
+// sync if syncing is on); safe to call from a thread other than the owner's
+bool writeJournal(ScoreStore *store, const JournalEntry *entries, int count)
+{
+    size_t size = sizeof(JournalEntry) * count;
+    uint64_t endOffset;
+    if (store->writerLock)
+    {
+        lockProcesses(store->writerLock);
+    }
+    pthread_mutex_lock(&store->journalLock);
+
+    // Another process that compacted has replaced the journal; runs go into the new one
+    FileStamp openStamp, pathStamp;
+    if (readAppendFileStamp(&store->journal, &openStamp) && readFileStamp(store->journalPath, &pathStamp) && openStamp.id != pathStamp.id)
+    {
+        closeAppendFile(&store->journal);
+        openAppendFile(&store->journal, store->journalPath);
+    }
+    bool ok = appendToFile(&store->journal, entries, size, &endOffset) && (!store->syncWrites || syncAppendFile(&store->journal));
+    if (ok)
+    {
+        // If another process appended since our last read, the read position stays
+        // put so refreshScoreStore() picks up its entries (and skips ours again)
+        if (endOffset == store->journalBytes + size)
+        {
+            store->journalBytes = endOffset;
+        }
+        __atomic_fetch_add(&store->journalEntries, (uint64_t)count, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&store->journalLock);
+    if (store->writerLock)
+    {
+        unlockProcesses(store->writerLock);
+    }
+    return ok;
+}
+
+// Function to apply a prepared entry to the records in memory
+bool applyScore(ScoreStore *store, const JournalEntry *entry, uint64_t *slotOut)
+{
+    uint64_t hash = hashBytes(entry->username, SCORE_NAME_SIZE, 0);
+    if (!applyRun(store, lookupName(store, entry->username, hash), entry->username, hash, entry->time, entry->successRatio, entry->sequence, slotOut))
+    {
+        return false;
+    }
+
+    // Fold the journal into a new snapshot once it is long enough to be worth it
+    int state = __atomic_load_n(&store->compaction.state, __ATOMIC_ACQUIRE);
+    uint64_t journalEntries = __atomic_load_n(&store->journalEntries, __ATOMIC_RELAXED);
+    if (state == COMPACTION_DONE)
+    {
+        finishCompaction(store);
+    }
+    else if (state == COMPACTION_IDLE && journalEntries >= SCORE_COMPACT_MIN_ENTRIES && journalEntries >= store->header->count / 4)
+    {
+        compactScoreStore(store, false);
+    }
+    return true;
+}
+
+// Function to add a player's run, or replace their record if the new run ranks higher;
+// slotOut (optional) receives the player's slot whether or not the record changed
+bool upsertScore(ScoreStore *store, const char *username, int time, double successRatio, uint64_t *slotOut)
+{
+    // The journal entry is written first, so memory never gets ahead of the disk
+    JournalEntry entry;
+    return prepareScore(store, username, time, successRatio, &entry, slotOut) && writeJournal(store, &entry, 1) && applyScore(store, &entry, slotOut);
+}
+
+// Function to turn per-write syncing on or off; bulk loads turn it off and call flushScoreStore()
+void setScoreStoreSync(ScoreStore *store, bool syncWrites)
+{
+    store->syncWrites = syncWrites;
+}
+
+// Function to make every run saved so far durable
+bool flushScoreStore(ScoreStore *store)
+{
+    // A compaction swaps the journal file under the lock
+    pthread_mutex_lock(&store->journalLock);
+    bool ok = syncAppendFile(&store->journal);
+    pthread_mutex_unlock(&store->journalLock);
+    return ok;
+}
+
+// Function to share a lock with the other processes using the same files, so
+// their journal writes and compactions take turns; NULL for this process alone
+void setScoreStoreWriterLock(ScoreStore *store, uint32_t *writerLock)
+{
+    store->writerLock = writerLock;
+}
+
+// Function to stream over every record in slot order without copying them
+void forEachScore(const ScoreStore *store, ScoreVisitor visitor, void *context)
+{
+    uint64_t count = storeScoreCount(store);
+    for (uint64_t i = 0; i < count; i++)
+    {
+        if (!visitor(&store->records[i], i, context))
+        {
+            return;
+        }
+    }
+}
+
+// Function to check the header checksum against every record
+bool verifyScoreStore(const ScoreStore *store)
+{
+    uint64_t checksum = 0;
+    uint64_t count = storeScoreCount(store);
+    for (uint64_t i = 0; i < count; i++)
+    {
+        checksum ^= recordHash(&store->records[i], i);
+    }
+    return checksum == store->header->checksum;
+}
+
+// Function to add every "username time ratio" line of a text score file
+bool importTextScores(ScoreStore *store, const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    // Sync once at the end instead of after every imported line
+    bool syncWrites = store->syncWrites;
+    store->syncWrites = false;
+
+    char username[SCORE_NAME_SIZE];
+    int time;
+    double successRatio;
+    while (fscanf(file, "%51s %d %lf", username, &time, &successRatio) == 3)
+    {
+        upsertScore(store, username, time, successRatio, NULL);
+    }
+
+    fclose(file);
+    store->syncWrites = syncWrites;
+    return !syncWrites || flushScoreStore(store);
+}
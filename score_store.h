@@ -0,0 +1,136 @@
+// Binary high score store
+// Fixed-size score records in a memory-mapped snapshot file with a
+// versioned, checksummed header, plus an append-only journal of the runs
+// saved since the snapshot was written. Loading is a single mapping and a
+// journal replay; saving a run is one small sequential append
+//
+// Snapshot layout: header | capacity records | hash index (2 * capacity entries)
+// The index maps a normalized username to its record slot with open
+// addressing, so finding a player is O(1) however many records there are.
+// The snapshot is mapped copy-on-write and only ever replaced as a whole (a
+// new file renamed over it), so readers never see a torn snapshot
+
+#ifndef SCORE_STORE_H
+#define SCORE_STORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "mapped_file.h"
+
+#define SCORE_STORE_MAGIC 0x45524f4353474e4eULL
+#define SCORE_STORE_VERSION 2
+#define SCORE_NAME_SIZE 52
+#define SCORE_PATH_SIZE 260
+#define SCORE_STORE_INITIAL_CAPACITY 64
+#define SCORE_JOURNAL_MAGIC 0x4c4e524aU
+#define SCORE_JOURNAL_SUFFIX ".log"
+
+// The journal is compacted into a new snapshot once it holds at least this
+// many runs and a quarter as many runs as there are players
+#define SCORE_COMPACT_MIN_ENTRIES 1024
+
+// Structure stored at the start of the snapshot
+typedef struct
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t capacity;
+    uint64_t count;
+    uint64_t nextSequence;
+    uint64_t checksum;
+    uint64_t indexCapacity;
+    uint64_t indexChecksum;
+} ScoreStoreHeader;
+
+// Structure of one player's best run, as stored on disk
+typedef struct
+{
+    char username[SCORE_NAME_SIZE];
+    int32_t time;
+    double successRatio;
+    uint64_t sequence;
+} ScoreRecord;
+
+// Structure of one saved run in the journal; the checksum covers everything after it
+typedef struct
+{
+    uint32_t magic;
+    uint32_t checksum;
+    uint64_t sequence;
+    char username[SCORE_NAME_SIZE];
+    int32_t time;
+    double successRatio;
+} JournalEntry;
+
+// States of the background compaction
+#define COMPACTION_IDLE 0
+#define COMPACTION_RUNNING 1
+#define COMPACTION_DONE 2
+
+// Structure to store a compaction that writes a snapshot on another thread
+typedef struct
+{
+    pthread_t thread;
+    int state;
+    bool succeeded;
+    void *image;
+    size_t imageSize;
+    uint64_t journalOffset;
+    FileStamp snapshotStamp;
+} ScoreCompaction;
+
+// Structure to store an open score store
+typedef struct
+{
+    MappedFile file;
+    ScoreStoreHeader *header;
+    ScoreRecord *records;
+    uint64_t *index;
+    bool syncWrites;
+    char path[SCORE_PATH_SIZE];
+    char journalPath[SCORE_PATH_SIZE];
+    AppendFile journal;
+    pthread_mutex_t journalLock;
+    FileStamp snapshotStamp;
+    uint64_t journalBytes;
+    uint64_t journalEntries;
+    uint32_t *writerLock;
+    ScoreCompaction compaction;
+} ScoreStore;
+
+// Callback for streaming over every record; return false to stop early
+typedef bool (*ScoreVisitor)(const ScoreRecord *record, uint64_t slot, void *context);
+
+// Function prototypes
+bool openScoreStore(ScoreStore *store, const char *path, const char *legacyPath);
+void closeScoreStore(ScoreStore *store);
+bool upsertScore(ScoreStore *store, const char *username, int time, double successRatio, uint64_t *slotOut);
+bool prepareScore(ScoreStore *store, const char *username, int time, double successRatio, JournalEntry *entry, uint64_t *slotOut);
+bool writeJournal(ScoreStore *store, const JournalEntry *entries, int count);
+bool applyScore(ScoreStore *store, const JournalEntry *entry, uint64_t *slotOut);
+void setScoreStoreSync(ScoreStore *store, bool syncWrites);
+bool flushScoreStore(ScoreStore *store);
+void setScoreStoreWriterLock(ScoreStore *store, uint32_t *writerLock);
+bool compactScoreStore(ScoreStore *store, bool wait);
+bool refreshScoreStore(ScoreStore *store, ScoreVisitor changed, void *context);
+void forEachScore(const ScoreStore *store, ScoreVisitor visitor, void *context);
+long long findScore(const ScoreStore *store, const char *username);
+bool verifyScoreStore(const ScoreStore *store);
+bool importTextScores(ScoreStore *store, const char *path);
+void normalizeUsername(char normalized[SCORE_NAME_SIZE], const char *username);
+
+// Function to get the number of players in the store
+static inline uint64_t storeScoreCount(const ScoreStore *store)
+{
+    return store->header ? store->header->count : 0;
+}
+
+// Function to get the record in a slot (0 <= slot < storeScoreCount)
+static inline const ScoreRecord *storeRecord(const ScoreStore *store, uint64_t slot)
+{
+    return &store->records[slot];
+}
+
+#endif
@@ -0,0 +1,273 @@
+// Columnar score table
+// The string pool keeps every name once, packed, with an open-addressing
+// lookup from name to id; a leaderboard's names are mostly much shorter than
+// the 52 bytes a record reserves for them
+
+#include "score_table.h"
+#include "score_key.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TABLE_INITIAL_CAPACITY 64
+#define POOL_INITIAL_BYTES 1024
+
+// Function to hash a name for the pool lookup
+static uint32_t hashName(const char *name)
+{
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *c = (const unsigned char *)name; *c; c++)
+    {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Function to get an interned string by id
+static const char *poolString(const StringPool *pool, uint32_t id)
+{
+    return pool->bytes + pool->offsets[id];
+}
+
+// Function to rebuild the lookup with room for at least the given number of strings
+static bool growPoolLookup(StringPool *pool, uint64_t strings)
+{
+    uint32_t capacity = pool->lookupCapacity > 0 ? pool->lookupCapacity : TABLE_INITIAL_CAPACITY * 2;
+    while (capacity < strings * 2)
+    {
+        capacity *= 2;
+    }
+    if (capacity == pool->lookupCapacity)
+    {
+        return true;
+    }
+    uint32_t *lookup = (uint32_t *)malloc(sizeof(uint32_t) * capacity);
+    if (lookup == NULL)
+    {
+        return false;
+    }
+
+    // Entries hold id + 1, so 0 is an empty entry
+    memset(lookup, 0, sizeof(uint32_t) * capacity);
+    for (uint32_t id = 0; id < pool->count; id++)
+    {
+        uint32_t position = hashName(poolString(pool, id)) & (capacity - 1);
+        while (lookup[position] != 0)
+        {
+            position = (position + 1) & (capacity - 1);
+        }
+        lookup[position] = id + 1;
+    }
+    free(pool->lookup);
+    pool->lookup = lookup;
+    pool->lookupCapacity = capacity;
+    return true;
+}
+
+// Function to get the id of a name, adding it to the pool the first time; false if out of memory
+static bool internName(StringPool *pool, const char *name, uint32_t *id)
+{
+    if (!growPoolLookup(pool, (uint64_t)pool->count + 1))
+    {
+        return false;
+    }
+    uint32_t mask = pool->lookupCapacity - 1;
+    uint32_t position = hashName(name) & mask;
+    while (pool->lookup[position] != 0)
+    {
+        if (strcmp(poolString(pool, pool->lookup[position] - 1), name) == 0)
+        {
+            *id = pool->lookup[position] - 1;
+            return true;
+        }
+        position = (position + 1) & mask;
+    }
+
+    // Make room for the string and its offset
+    size_t length = strlen(name) + 1;
+    if (pool->used + length > pool->size)
+    {
+        size_t size = pool->size > 0 ? pool->size : POOL_INITIAL_BYTES;
+        while (pool->used + length > size)
+        {
+            size *= 2;
+        }
+        char *bytes = (char *)realloc(pool->bytes, size);
+        if (bytes == NULL)
+        {
+            return false;
+        }
+        pool->bytes = bytes;
+        pool->size = size;
+    }
+    if (pool->count == pool->capacity)
+    {
+        uint32_t capacity = pool->capacity > 0 ? pool->capacity * 2 : TABLE_INITIAL_CAPACITY;
+        uint64_t *offsets = (uint64_t *)realloc(pool->offsets, sizeof(uint64_t) * capacity);
+        if (offsets == NULL)
+        {
+            return false;
+        }
+        pool->offsets = offsets;
+        pool->capacity = capacity;
+    }
+
+    memcpy(pool->bytes + pool->used, name, length);
+    pool->offsets[pool->count] = pool->used;
+    pool->used += length;
+    pool->lookup[position] = pool->count + 1;
+    *id = pool->count++;
+    return true;
+}
+
+// Function to start an empty table
+void initScoreTable(ScoreTable *table)
+{
+    memset(table, 0, sizeof(*table));
+}
+
+// Function to free every column and the name pool
+void freeScoreTable(ScoreTable *table)
+{
+    free(table->keys);
+    free(table->ratios);
+    free(table->times);
+    free(table->nameIds);
+    free(table->names.bytes);
+    free(table->names.offsets);
+    free(table->names.lookup);
+    memset(table, 0, sizeof(*table));
+}
+
+// Function to grow every column to hold at least the given number of rows
+static bool reserveRows(ScoreTable *table, uint64_t rows)
+{
+    if (rows <= table->capacity)
+    {
+        return true;
+    }
+    uint64_t capacity = table->capacity > 0 ? table->capacity : TABLE_INITIAL_CAPACITY;
+    while (capacity < rows)
+    {
+        capacity *= 2;
+    }
+
+    // Each column is reallocated on its own, so a failure leaves the others valid
+    uint64_t *keys = (uint64_t *)realloc(table->keys, sizeof(uint64_t) * capacity);
+    if (keys == NULL)
+    {
+        return false;
+    }
+    table->keys = keys;
+    double *ratios = (double *)realloc(table->ratios, sizeof(double) * capacity);
+    if (ratios == NULL)
+    {
+        return false;
+    }
+    table->ratios = ratios;
+    int32_t *times = (int32_t *)realloc(table->times, sizeof(int32_t) * capacity);
+    if (times == NULL)
+    {
+        return false;
+    }
+    table->times = times;
+    uint32_t *nameIds = (uint32_t *)realloc(table->nameIds, sizeof(uint32_t) * capacity);
+    if (nameIds == NULL)
+    {
+        return false;
+    }
+    table->nameIds = nameIds;
+    table->capacity = capacity;
+    return true;
+}
+
+// Function to write a store record into a row; row may be one past the last row to add it
+bool setScoreRow(ScoreTable *table, uint64_t row, const ScoreRecord *record)
+{
+    if (row > table->count || !reserveRows(table, row + 1))
+    {
+        return false;
+    }
+
+    // A player keeps their name, so only a new row interns one
+    if (row == table->count)
+    {
+        char name[SCORE_NAME_SIZE];
+        memcpy(name, record->username, SCORE_NAME_SIZE);
+        name[SCORE_NAME_SIZE - 1] = '\0';
+        if (!internName(&table->names, name, &table->nameIds[row]))
+        {
+            return false;
+        }
+        table->count++;
+    }
+    table->keys[row] = scoreKey(record->successRatio, record->time, record->sequence);
+    table->ratios[row] = record->successRatio;
+    table->times[row] = record->time;
+    return true;
+}
+
+// Function to fill the table from every record of the store, in slot order
+bool loadScoreTable(ScoreTable *table, const ScoreStore *store)
+{
+    // Size the lookup for every name up front instead of rehashing it as it fills
+    uint64_t count = storeScoreCount(store);
+    if (!reserveRows(table, count) || !growPoolLookup(&table->names, count))
+    {
+        return false;
+    }
+    for (uint64_t slot = table->count; slot < count; slot++)
+    {
+        if (!setScoreRow(table, slot, storeRecord(store, slot)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Function to read one row back
+void getScoreRow(const ScoreTable *table, uint64_t row, ScoreRow *out)
+{
+    out->username = poolString(&table->names, table->nameIds[row]);
+    out->successRatio = table->ratios[row];
+    out->time = table->times[row];
+    out->key = table->keys[row];
+}
+
+// Function to count the players whose ratio is in [minRatio, maxRatio];
+// a branch-free loop over one column, which compilers turn into SIMD compares
+uint64_t countScoresInRange(const ScoreTable *table, double minRatio, double maxRatio)
+{
+    const double *ratios = table->ratios;
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < table->count; i++)
+    {
+        count += (ratios[i] >= minRatio) & (ratios[i] <= maxRatio);
+    }
+    return count;
+}
+
+// Function to count the players whose key ranks above the given key, over the key column alone
+uint64_t countKeysAbove(const ScoreTable *table, uint64_t key)
+{
+    const uint64_t *keys = table->keys;
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < table->count; i++)
+    {
+        count += keys[i] > key;
+    }
+    return count;
+}
+
+// Function to add up the memory each column and the name pool use
+void measureScoreTable(const ScoreTable *table, ScoreTableFootprint *footprint)
+{
+    const StringPool *pool = &table->names;
+    footprint->keys = sizeof(uint64_t) * table->capacity;
+    footprint->ratios = sizeof(double) * table->capacity;
+    footprint->times = sizeof(int32_t) * table->capacity;
+    footprint->nameIds = sizeof(uint32_t) * table->capacity;
+    footprint->namePool = pool->size + sizeof(uint64_t) * pool->capacity + sizeof(uint32_t) * pool->lookupCapacity;
+    footprint->total = footprint->keys + footprint->ratios + footprint->times + footprint->nameIds + footprint->namePool;
+}
@@ -0,0 +1,69 @@
+// Columnar score table
+// The leaderboard's copy of every player as one array per field, so a scan
+// reads only the columns it needs and the compiler can vectorize over them;
+// usernames are interned in a string pool. Row i is the player in store slot i
+
+#ifndef SCORE_TABLE_H
+#define SCORE_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "score_store.h"
+
+// Structure to store interned strings back to back, each ending in '\0'
+typedef struct
+{
+    char *bytes;
+    size_t used;
+    size_t size;
+    uint64_t *offsets;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *lookup;
+    uint32_t lookupCapacity;
+} StringPool;
+
+// Structure to store one column per field of every row
+typedef struct
+{
+    uint64_t *keys;
+    double *ratios;
+    int32_t *times;
+    uint32_t *nameIds;
+    uint64_t count;
+    uint64_t capacity;
+    StringPool names;
+} ScoreTable;
+
+// Structure to store one row read back from the table
+typedef struct
+{
+    const char *username;
+    double successRatio;
+    int time;
+    uint64_t key;
+} ScoreRow;
+
+// Structure to store the memory the table uses, in bytes
+typedef struct
+{
+    size_t keys;
+    size_t ratios;
+    size_t times;
+    size_t nameIds;
+    size_t namePool;
+    size_t total;
+} ScoreTableFootprint;
+
+// Function prototypes
+void initScoreTable(ScoreTable *table);
+void freeScoreTable(ScoreTable *table);
+bool loadScoreTable(ScoreTable *table, const ScoreStore *store);
+bool setScoreRow(ScoreTable *table, uint64_t row, const ScoreRecord *record);
+void getScoreRow(const ScoreTable *table, uint64_t row, ScoreRow *out);
+uint64_t countScoresInRange(const ScoreTable *table, double minRatio, double maxRatio);
+uint64_t countKeysAbove(const ScoreTable *table, uint64_t key);
+void measureScoreTable(const ScoreTable *table, ScoreTableFootprint *footprint);
+
+#endif
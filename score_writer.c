@@ -0,0 +1,124 @@
+// Write-behind worker for saved runs
+// The queue holds at most one entry per player: a newer entry for a player
+// who is still queued replaces the old one, since it can only be a better run
+
+#include "score_writer.h"
+#include <stdio.h>
+#include <string.h>
+
+// Function to write queued entries until the writer is stopped and the queue is empty
+static void *writerThread(void *context)
+{
+    ScoreWriter *writer = (ScoreWriter *)context;
+    JournalEntry batch[SCORE_WRITER_QUEUE_SIZE];
+
+    pthread_mutex_lock(&writer->lock);
+    for (;;)
+    {
+        while (writer->count == 0 && !writer->stopping)
+        {
+            pthread_cond_wait(&writer->changed, &writer->lock);
+        }
+        if (writer->count == 0)
+        {
+            break;
+        }
+
+        // Take the whole queue, so producers can queue again while it is written
+        int count = writer->count;
+        memcpy(batch, writer->queue, sizeof(JournalEntry) * count);
+        writer->count = 0;
+        writer->writing = true;
+        pthread_cond_broadcast(&writer->changed);
+        pthread_mutex_unlock(&writer->lock);
+
+        if (!writeJournal(writer->store, batch, count))
+        {
+            printf("%d score(s) could not be saved!\n", count);
+        }
+
+        pthread_mutex_lock(&writer->lock);
+        writer->writing = false;
+        pthread_cond_broadcast(&writer->changed);
+    }
+    pthread_mutex_unlock(&writer->lock);
+    return NULL;
+}
+
+// Function to start the worker thread writing to a store
+bool startScoreWriter(ScoreWriter *writer, ScoreStore *store)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->store = store;
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->changed, NULL);
+    writer->running = pthread_create(&writer->thread, NULL, writerThread, writer) == 0;
+    if (!writer->running)
+    {
+        printf("Score writer thread could not be created, saving on the caller's thread\n");
+    }
+    return writer->running;
+}
+
+// Function to queue an entry for writing, replacing a queued entry of the same player
+void queueScoreWrite(ScoreWriter *writer, const JournalEntry *entry)
+{
+    // Without a worker the entry is written right away
+    if (!writer->running)
+    {
+        if (!writeJournal(writer->store, entry, 1))
+        {
+            printf("Score could not be saved!\n");
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&writer->lock);
+    for (int i = 0; i < writer->count; i++)
+    {
+        if (memcmp(writer->queue[i].username, entry->username, SCORE_NAME_SIZE) == 0)
+        {
+            writer->queue[i] = *entry;
+            pthread_mutex_unlock(&writer->lock);
+            return;
+        }
+    }
+    while (writer->count == SCORE_WRITER_QUEUE_SIZE)
+    {
+        pthread_cond_wait(&writer->changed, &writer->lock);
+    }
+    writer->queue[writer->count++] = *entry;
+    pthread_cond_broadcast(&writer->changed);
+    pthread_mutex_unlock(&writer->lock);
+}
+
+// Function to wait until every queued entry has been written
+void flushScoreWriter(ScoreWriter *writer)
+{
+    if (!writer->running)
+    {
+        return;
+    }
+    pthread_mutex_lock(&writer->lock);
+    while (writer->count > 0 || writer->writing)
+    {
+        pthread_cond_wait(&writer->changed, &writer->lock);
+    }
+    pthread_mutex_unlock(&writer->lock);
+}
+
+// Function to write everything still queued and stop the worker thread
+void stopScoreWriter(ScoreWriter *writer)
+{
+    if (writer->running)
+    {
+        pthread_mutex_lock(&writer->lock);
+        writer->stopping = true;
+        pthread_cond_broadcast(&writer->changed);
+        pthread_mutex_unlock(&writer->lock);
+        pthread_join(writer->thread, NULL);
+        writer->running = false;
+    }
+    pthread_cond_destroy(&writer->changed);
+    pthread_mutex_destroy(&writer->lock);
+}
@@ -0,0 +1,36 @@
+// Write-behind worker for saved runs
+// Runs are applied to the leaderboard in memory right away and their journal
+// entries are queued here, so the game never waits on a write or an fsync.
+// A worker thread writes whatever has queued up with one append and one sync
+
+#ifndef SCORE_WRITER_H
+#define SCORE_WRITER_H
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "score_store.h"
+
+// Most entries waiting to be written; a full queue makes queueScoreWrite() wait
+#define SCORE_WRITER_QUEUE_SIZE 64
+
+// Structure to store the worker and the entries it has not written yet
+typedef struct
+{
+    ScoreStore *store;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    JournalEntry queue[SCORE_WRITER_QUEUE_SIZE];
+    int count;
+    bool writing;
+    bool stopping;
+    bool running;
+} ScoreWriter;
+
+// Function prototypes
+bool startScoreWriter(ScoreWriter *writer, ScoreStore *store);
+void queueScoreWrite(ScoreWriter *writer, const JournalEntry *entry);
+void flushScoreWriter(ScoreWriter *writer);
+void stopScoreWriter(ScoreWriter *writer);
+
+#endif
@@ -0,0 +1,66 @@
+// Pool of game sessions for servers
+// A released session keeps its buffers, so the next player to acquire it only
+// gets a new seed; sessions from the pool must never be passed to freeSession()
+
+#include "session_pool.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Function to allocate capacity sessions, each with its four digit buffers
+bool initSessionPool(SessionPool *pool, int capacity)
+{
+    memset(pool, 0, sizeof(*pool));
+    pool->sessions = (GameSession *)calloc(capacity, sizeof(GameSession));
+    pool->digits = (uint64_t *)malloc(sizeof(uint64_t) * capacity * 4 * POOL_DIGIT_WORDS);
+    pool->freeList = (int *)malloc(sizeof(int) * capacity);
+    if (pool->sessions == NULL || pool->digits == NULL || pool->freeList == NULL)
+    {
+        freeSessionPool(pool);
+        return false;
+    }
+    pool->capacity = capacity;
+
+    // Hand sessions out from the front, so a lightly loaded pool stays in a few pages
+    for (int i = 0; i < capacity; i++)
+    {
+        uint64_t *digits = pool->digits + (size_t)i * 4 * POOL_DIGIT_WORDS;
+        DigitBuffer buffer = {digits, POOL_DIGIT_WORDS * DIGITS_PER_WORD};
+        pool->sessions[i].magicNumber = buffer;
+        buffer.words += POOL_DIGIT_WORDS;
+        pool->sessions[i].guessed = buffer;
+        buffer.words += POOL_DIGIT_WORDS;
+        pool->sessions[i].formatted = buffer;
+        buffer.words += POOL_DIGIT_WORDS;
+        pool->sessions[i].liveFormatted = buffer;
+        pool->freeList[i] = capacity - 1 - i;
+    }
+    pool->freeCount = capacity;
+    return true;
+}
+
+// Function to release the pool's memory
+void freeSessionPool(SessionPool *pool)
+{
+    free(pool->sessions);
+    free(pool->digits);
+    free(pool->freeList);
+    memset(pool, 0, sizeof(*pool));
+}
+
+// Function to take a free session and start it at the first level; NULL if every session is in use
+GameSession *acquireSession(SessionPool *pool, uint64_t seed)
+{
+    if (pool->freeCount == 0)
+    {
+        return NULL;
+    }
+    GameSession *session = &pool->sessions[pool->freeList[--pool->freeCount]];
+    initSession(session, seed);
+    return session;
+}
+
+// Function to give a session back to the pool
+void releaseSession(SessionPool *pool, GameSession *session)
+{
+    pool->freeList[pool->freeCount++] = (int)(session - pool->sessions);
+}
@@ -0,0 +1,32 @@
+// Pool of game sessions for servers
+// Every session and its digit buffers are carved out of a few allocations
+// made up front, so starting and ending a game never touches the heap
+
+#ifndef SESSION_POOL_H
+#define SESSION_POOL_H
+
+#include <stdbool.h>
+#include "game_core.h"
+
+// Text size that fits the longest level's number and its terminator, and the
+// packed words that hold that number
+#define POOL_DIGIT_BUFFER (DEFAULT_NUM_LENGTH + MAX_GAME_LEVEL)
+#define POOL_DIGIT_WORDS DIGIT_WORDS(POOL_DIGIT_BUFFER - 1)
+
+// Structure to store the pooled sessions and the indices of the free ones
+typedef struct
+{
+    GameSession *sessions;
+    uint64_t *digits;
+    int *freeList;
+    int freeCount;
+    int capacity;
+} SessionPool;
+
+// Function prototypes
+bool initSessionPool(SessionPool *pool, int capacity);
+void freeSessionPool(SessionPool *pool);
+GameSession *acquireSession(SessionPool *pool, uint64_t seed);
+void releaseSession(SessionPool *pool, GameSession *session);
+
+#endif
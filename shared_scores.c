@@ -0,0 +1,204 @@
+// Shared top scores for game instances on one host
+// The list is only ever merged into: a player's entry is replaced by a
+// better run and the list keeps the best capacity players, the same rule
+// the store uses, so the order runs are published in does not matter and an
+// instance can publish its whole top list on start to fill in a fresh file
+
+#include "shared_scores.h"
+#include "process_lock.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#endif
+
+// Magic value while the first instance is filling in a new file
+#define SHARED_SCORES_CREATING 1
+
+// Times a reader retries before it gives up on a list a dead writer left half written
+#define SHARED_READ_ATTEMPTS 1000
+
+// Function to wait a moment for another process
+static void pauseForProcess()
+{
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+// Function to open the file next to the store, creating and filling in its header if it is new
+bool openSharedScores(SharedScores *shared, const char *storePath, int capacity)
+{
+    memset(shared, 0, sizeof(*shared));
+    char path[SCORE_PATH_SIZE];
+    snprintf(path, sizeof(path), "%s%s", storePath, SHARED_SCORES_SUFFIX);
+    if (!mapFile(&shared->file, path, sizeof(SharedScoreHeader), true) || shared->file.size < sizeof(SharedScoreHeader))
+    {
+        unmapFile(&shared->file);
+        return false;
+    }
+    SharedScoreHeader *header = (SharedScoreHeader *)shared->file.data;
+
+    // Exactly one instance moves a zeroed (or incompatible) file to the creating state and fills it in
+    for (int attempt = 0;; attempt++)
+    {
+        uint64_t magic = __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE);
+        if (magic == SHARED_SCORES_MAGIC && header->version == SHARED_SCORES_VERSION)
+        {
+            break;
+        }
+
+        // A creator that crashed part way leaves the creating state behind; after a while it is taken over
+        bool stale = magic == SHARED_SCORES_CREATING && attempt > 100000;
+        if ((magic != SHARED_SCORES_CREATING || stale) &&
+            __atomic_compare_exchange_n(&header->magic, &magic, (uint64_t)SHARED_SCORES_CREATING, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            memset((char *)header + sizeof(header->magic), 0, sizeof(*header) - sizeof(header->magic));
+            header->version = SHARED_SCORES_VERSION;
+            header->capacity = capacity < 1 ? 1 : capacity > SHARED_TOP_MAX ? SHARED_TOP_MAX : capacity;
+            __atomic_store_n(&header->magic, SHARED_SCORES_MAGIC, __ATOMIC_RELEASE);
+            break;
+        }
+        pauseForProcess();
+    }
+    shared->header = header;
+    return true;
+}
+
+// Function to unmap the shared file; it stays on disk for the other instances
+void closeSharedScores(SharedScores *shared)
+{
+    unmapFile(&shared->file);
+    memset(shared, 0, sizeof(*shared));
+}
+
+// Function to merge one run into the list, which is best first
+static void mergeSharedScore(SharedScoreHeader *header, const SharedScore *score)
+{
+    // Drop the player's old entry unless it is at least as good
+    for (int i = 0; i < header->count; i++)
+    {
+        if (strncmp(header->entries[i].username, score->username, SCORE_NAME_SIZE) == 0)
+        {
+            if (header->entries[i].key >= score->key)
+            {
+                return;
+            }
+            memmove(&header->entries[i], &header->entries[i + 1], sizeof(SharedScore) * (header->count - i - 1));
+            header->count--;
+            break;
+        }
+    }
+
+    int position = header->count;
+    while (position > 0 && score->key > header->entries[position - 1].key)
+    {
+        position--;
+    }
+    if (position >= header->capacity)
+    {
+        return;
+    }
+    int moved = (header->count < header->capacity ? header->count : header->capacity - 1) - position;
+    memmove(&header->entries[position + 1], &header->entries[position], sizeof(SharedScore) * moved);
+    header->entries[position] = *score;
+    if (header->count < header->capacity)
+    {
+        header->count++;
+    }
+}
+
+// Function to put back in order a list a writer died in the middle of:
+// entries may be missing, doubled or out of place after a half-done move
+static void repairSharedScores(SharedScoreHeader *header)
+{
+    int count = header->count < 0 ? 0 : header->count > header->capacity ? header->capacity : header->count;
+
+    // Best first again, by insertion since the list is short and nearly sorted
+    for (int i = 1; i < count; i++)
+    {
+        SharedScore score = header->entries[i];
+        int j = i;
+        while (j > 0 && header->entries[j - 1].key < score.key)
+        {
+            header->entries[j] = header->entries[j - 1];
+            j--;
+        }
+        header->entries[j] = score;
+    }
+
+    // Keep each player's best entry, which is now their first
+    int kept = 0;
+    for (int i = 0; i < count; i++)
+    {
+        bool seen = false;
+        for (int j = 0; j < kept && !seen; j++)
+        {
+            seen = strncmp(header->entries[j].username, header->entries[i].username, SCORE_NAME_SIZE) == 0;
+        }
+        if (!seen)
+        {
+            header->entries[kept++] = header->entries[i];
+        }
+    }
+    header->count = kept;
+}
+
+// Function to merge runs into the shared list as one change readers see all at once
+void publishSharedScores(SharedScores *shared, const SharedScore scores[], int count)
+{
+    SharedScoreHeader *header = shared->header;
+    lockProcesses(&header->listLock);
+
+    // An odd sequence tells readers a write is under way; finding one here
+    // means the last writer died mid-write, so the count is moved back to
+    // even and the list it left is repaired before anything is merged
+    uint32_t sequence = header->sequence;
+    bool interrupted = (sequence & 1) != 0;
+    sequence += interrupted;
+    __atomic_store_n(&header->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    if (interrupted)
+    {
+        repairSharedScores(header);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        mergeSharedScore(header, &scores[i]);
+    }
+    __atomic_store_n(&header->sequence, sequence + 2, __ATOMIC_RELEASE);
+
+    unlockProcesses(&header->listLock);
+}
+
+// Function to copy up to maxScores of the list, best first, without waiting
+// on writers: a copy that overlapped a write is thrown away and taken again.
+// Returns -1 if the list stays mid-write, as when its writer died and no
+// other has come along to repair it yet
+int readSharedScores(const SharedScores *shared, SharedScore scores[], int maxScores)
+{
+    const SharedScoreHeader *header = shared->header;
+    for (int attempt = 0; attempt < SHARED_READ_ATTEMPTS; attempt++)
+    {
+        uint32_t before = __atomic_load_n(&header->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1)
+        {
+            pauseForProcess();
+            continue;
+        }
+        int count = header->count;
+        count = count < 0 ? 0 : count > maxScores ? maxScores : count > SHARED_TOP_MAX ? SHARED_TOP_MAX : count;
+        memcpy(scores, header->entries, sizeof(SharedScore) * count);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&header->sequence, __ATOMIC_RELAXED) == before)
+        {
+            return count;
+        }
+    }
+    return -1;
+}
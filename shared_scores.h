@@ -0,0 +1,58 @@
+// Shared top scores for game instances on one host
+// A small file next to the score store, mapped by every instance, holding
+// the lock that orders their journal writes and compactions and the best
+// players in order. Writers publish under a lock of the list's own (so a
+// compaction holding the writers' lock never delays them) and a sequence counter
+// (a seqlock), so readers never wait: they copy and retry if a write overlapped.
+// A writer that dies mid-write is cleaned up after by the next one to publish
+
+#ifndef SHARED_SCORES_H
+#define SHARED_SCORES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mapped_file.h"
+#include "score_store.h"
+
+#define SHARED_SCORES_MAGIC 0x53455243534d4853ULL
+#define SHARED_SCORES_VERSION 2
+#define SHARED_SCORES_SUFFIX ".shm"
+#define SHARED_TOP_MAX 128
+
+// Structure of one shared top score, best first in the list
+typedef struct
+{
+    char username[SCORE_NAME_SIZE];
+    int32_t time;
+    double successRatio;
+    uint64_t key;
+} SharedScore;
+
+// Structure of the whole shared file; the first instance to create it sets the capacity.
+// writerLock orders journal writes and compactions, listLock orders publishes
+typedef struct
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t writerLock;
+    uint32_t sequence;
+    int32_t capacity;
+    int32_t count;
+    uint32_t listLock;
+    SharedScore entries[SHARED_TOP_MAX];
+} SharedScoreHeader;
+
+// Structure to store an open shared file
+typedef struct
+{
+    MappedFile file;
+    SharedScoreHeader *header;
+} SharedScores;
+
+// Function prototypes
+bool openSharedScores(SharedScores *shared, const char *storePath, int capacity);
+void closeSharedScores(SharedScores *shared);
+void publishSharedScores(SharedScores *shared, const SharedScore scores[], int count);
+int readSharedScores(const SharedScores *shared, SharedScore scores[], int maxScores);
+
+#endif
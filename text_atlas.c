@@ -0,0 +1,244 @@
+// Glyph atlas text renderer
+// The font is only touched in createTextAtlas(); drawing a string afterwards just
+// appends quads that flushTextAtlas() submits in a single draw call
+
+#include "text_atlas.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// Space left between glyphs so linear filtering never bleeds into a neighbour
+#define ATLAS_PADDING 1
+#define ATLAS_INITIAL_QUADS 256
+
+// Function to grow the quad batch so it can hold at least quadCount quads
+static bool reserveQuads(TextAtlas *atlas, int quadCount)
+{
+    if (quadCount <= atlas->quadCapacity)
+    {
+        return true;
+    }
+
+    int capacity = atlas->quadCapacity > 0 ? atlas->quadCapacity : ATLAS_INITIAL_QUADS;
+    while (capacity < quadCount)
+    {
+        capacity *= 2;
+    }
+
+    SDL_Vertex *vertices = (SDL_Vertex *)realloc(atlas->vertices, sizeof(SDL_Vertex) * 4 * capacity);
+    if (vertices == NULL)
+    {
+        return false;
+    }
+    atlas->vertices = vertices;
+
+    int *indices = (int *)realloc(atlas->indices, sizeof(int) * 6 * capacity);
+    if (indices == NULL)
+    {
+        return false;
+    }
+    atlas->indices = indices;
+
+    // The index pattern never changes, so it is written once per new quad slot
+    for (int i = atlas->quadCapacity; i < capacity; i++)
+    {
+        indices[i * 6 + 0] = i * 4 + 0;
+        indices[i * 6 + 1] = i * 4 + 1;
+        indices[i * 6 + 2] = i * 4 + 2;
+        indices[i * 6 + 3] = i * 4 + 0;
+        indices[i * 6 + 4] = i * 4 + 2;
+        indices[i * 6 + 5] = i * 4 + 3;
+    }
+    atlas->quadCapacity = capacity;
+    return true;
+}
+
+// Function to rasterize every glyph of the font into one texture
+bool createTextAtlas(TextAtlas *atlas, SDL_Renderer *renderer, TTF_Font *font)
+{
+    memset(atlas, 0, sizeof(*atlas));
+    atlas->lineHeight = TTF_FontHeight(font);
+
+    // Render every glyph once, white, so vertex colors can tint them later
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface *glyphSurfaces[ATLAS_GLYPH_COUNT];
+    memset(glyphSurfaces, 0, sizeof(glyphSurfaces));
+
+    // Lay the glyphs out in rows to find the size of the atlas
+    int penX = ATLAS_PADDING;
+    int penY = ATLAS_PADDING;
+    int rowHeight = 0;
+    for (int i = 0; i < ATLAS_GLYPH_COUNT; i++)
+    {
+        Uint16 ch = (Uint16)(ATLAS_FIRST_GLYPH + i);
+        int advance = 0;
+        if (TTF_GlyphMetrics(font, ch, NULL, NULL, NULL, NULL, &advance) == 0)
+        {
+            atlas->glyphAdvance[i] = advance;
+        }
+
+        // Control characters and glyphs the font lacks only advance the pen
+        if (ch == ' ' || (ch >= 127 && ch < 160) || !TTF_GlyphIsProvided(font, ch))
+        {
+            continue;
+        }
+
+        glyphSurfaces[i] = TTF_RenderGlyph_Blended(font, ch, white);
+        if (glyphSurfaces[i] == NULL)
+        {
+            continue;
+        }
+
+        int w = glyphSurfaces[i]->w;
+        int h = glyphSurfaces[i]->h;
+        if (penX + w + ATLAS_PADDING > ATLAS_TEXTURE_WIDTH)
+        {
+            penX = ATLAS_PADDING;
+            penY += rowHeight + ATLAS_PADDING;
+            rowHeight = 0;
+        }
+        atlas->glyphRects[i].x = penX;
+        atlas->glyphRects[i].y = penY;
+        atlas->glyphRects[i].w = w;
+        atlas->glyphRects[i].h = h;
+        penX += w + ATLAS_PADDING;
+        if (h > rowHeight)
+        {
+            rowHeight = h;
+        }
+    }
+    atlas->textureWidth = ATLAS_TEXTURE_WIDTH;
+    atlas->textureHeight = penY + rowHeight + ATLAS_PADDING;
+
+    // Copy the glyphs into one surface, keeping their alpha as-is
+    SDL_Surface *atlasSurface = SDL_CreateRGBSurfaceWithFormat(0, atlas->textureWidth, atlas->textureHeight, 32, SDL_PIXELFORMAT_RGBA32);
+    bool ok = atlasSurface != NULL;
+    if (!ok)
+    {
+        printf("SDL_CreateRGBSurfaceWithFormat Error: %s\n", SDL_GetError());
+    }
+    for (int i = 0; i < ATLAS_GLYPH_COUNT; i++)
+    {
+        if (glyphSurfaces[i] == NULL)
+        {
+            continue;
+        }
+        if (ok)
+        {
+            SDL_SetSurfaceBlendMode(glyphSurfaces[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(glyphSurfaces[i], NULL, atlasSurface, &atlas->glyphRects[i]);
+        }
+        SDL_FreeSurface(glyphSurfaces[i]);
+    }
+    if (!ok)
+    {
+        return false;
+    }
+
+    atlas->texture = SDL_CreateTextureFromSurface(renderer, atlasSurface);
+    SDL_FreeSurface(atlasSurface);
+    if (atlas->texture == NULL)
+    {
+        printf("SDL_CreateTextureFromSurface Error: %s\n", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+
+    return reserveQuads(atlas, ATLAS_INITIAL_QUADS);
+}
+
+// Function to release the atlas texture and the quad batch
+void destroyTextAtlas(TextAtlas *atlas)
+{
+    if (atlas->texture)
+    {
+        SDL_DestroyTexture(atlas->texture);
+    }
+    free(atlas->vertices);
+    free(atlas->indices);
+    memset(atlas, 0, sizeof(*atlas));
+}
+
+// Function to get the width in pixels of a string drawn with the atlas
+int measureAtlasText(const TextAtlas *atlas, const char *text)
+{
+    int width = 0;
+    for (const unsigned char *c = (const unsigned char *)text; *c; c++)
+    {
+        if (*c >= ATLAS_FIRST_GLYPH)
+        {
+            width += atlas->glyphAdvance[*c - ATLAS_FIRST_GLYPH];
+        }
+    }
+    return width;
+}
+
+// Function to queue a string for drawing at (x, y) in the given color
+void drawAtlasText(TextAtlas *atlas, const char *text, int x, int y, SDL_Color color)
+{
+    if (atlas->texture == NULL)
+    {
+        return;
+    }
+
+    // The game's colors leave alpha at 0, which TTF_RenderText_Solid ignored
+    color.a = 255;
+
+    float invWidth = 1.0f / atlas->textureWidth;
+    float invHeight = 1.0f / atlas->textureHeight;
+    int penX = x;
+    for (const unsigned char *c = (const unsigned char *)text; *c; c++)
+    {
+        if (*c < ATLAS_FIRST_GLYPH)
+        {
+            continue;
+        }
+        int glyph = *c - ATLAS_FIRST_GLYPH;
+        const SDL_Rect *src = &atlas->glyphRects[glyph];
+        if (src->w > 0 && reserveQuads(atlas, atlas->quadCount + 1))
+        {
+            SDL_Vertex *v = &atlas->vertices[atlas->quadCount * 4];
+            float left = (float)penX;
+            float top = (float)y;
+            float right = left + src->w;
+            float bottom = top + src->h;
+            float u0 = src->x * invWidth;
+            float v0 = src->y * invHeight;
+            float u1 = (src->x + src->w) * invWidth;
+            float v1 = (src->y + src->h) * invHeight;
+
+            v[0].position.x = left;
+            v[0].position.y = top;
+            v[0].tex_coord.x = u0;
+            v[0].tex_coord.y = v0;
+            v[1].position.x = right;
+            v[1].position.y = top;
+            v[1].tex_coord.x = u1;
+            v[1].tex_coord.y = v0;
+            v[2].position.x = right;
+            v[2].position.y = bottom;
+            v[2].tex_coord.x = u1;
+            v[2].tex_coord.y = v1;
+            v[3].position.x = left;
+            v[3].position.y = bottom;
+            v[3].tex_coord.x = u0;
+            v[3].tex_coord.y = v1;
+            for (int i = 0; i < 4; i++)
+            {
+                v[i].color = color;
+            }
+            atlas->quadCount++;
+        }
+        penX += atlas->glyphAdvance[glyph];
+    }
+}
+
+// Function to draw every queued quad with a single call and empty the batch
+void flushTextAtlas(TextAtlas *atlas, SDL_Renderer *renderer)
+{
+    if (atlas->quadCount > 0)
+    {
+        SDL_RenderGeometry(renderer, atlas->texture, atlas->vertices, atlas->quadCount * 4, atlas->indices, atlas->quadCount * 6);
+        atlas->quadCount = 0;
+    }
+}
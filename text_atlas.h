@@ -0,0 +1,41 @@
+// Glyph atlas used to draw all of the game's text
+// Every glyph of the font is rasterized once into a single texture, and strings
+// are drawn as batched quads so a frame needs no TTF calls or texture allocations
+
+#ifndef TEXT_ATLAS_H
+#define TEXT_ATLAS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdbool.h>
+
+// Glyphs cover the Latin-1 range that TTF_RenderText_* accepts
+#define ATLAS_FIRST_GLYPH 32
+#define ATLAS_GLYPH_COUNT (256 - ATLAS_FIRST_GLYPH)
+#define ATLAS_TEXTURE_WIDTH 512
+
+// Structure to store the atlas texture and the position of every glyph in it
+typedef struct
+{
+    SDL_Texture *texture;
+    int textureWidth;
+    int textureHeight;
+    int lineHeight;
+    SDL_Rect glyphRects[ATLAS_GLYPH_COUNT];
+    int glyphAdvance[ATLAS_GLYPH_COUNT];
+
+    // Quads queued since the last flush, drawn with one SDL_RenderGeometry call
+    SDL_Vertex *vertices;
+    int *indices;
+    int quadCount;
+    int quadCapacity;
+} TextAtlas;
+
+// Function prototypes
+bool createTextAtlas(TextAtlas *atlas, SDL_Renderer *renderer, TTF_Font *font);
+void destroyTextAtlas(TextAtlas *atlas);
+int measureAtlasText(const TextAtlas *atlas, const char *text);
+void drawAtlasText(TextAtlas *atlas, const char *text, int x, int y, SDL_Color color);
+void flushTextAtlas(TextAtlas *atlas, SDL_Renderer *renderer);
+
+#endif
@@ -0,0 +1,245 @@
+// Top-K list for the leaderboard
+// heap[0] is the worst of the K; entries tie on key only for runs past the
+// key's sequence range, and then the later slot counts as worse, the same
+// order the rank index uses. The lookup is an open-addressing table from
+// slot to heap position, and heapCells[i] is the lookup cell of heap[i] so
+// moving an entry in the heap updates its cell directly. Every change that
+// reaches the list also moves its entry in the view, found by binary search,
+// which costs a memmove of at most K small entries
+
+#include "top_scores.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Function to check whether entry a ranks below entry b
+static bool ranksBelow(const TopEntry *a, const TopEntry *b)
+{
+    if (a->key != b->key)
+    {
+        return a->key < b->key;
+    }
+    return a->slot > b->slot;
+}
+
+// Function to get a slot's first lookup cell
+static uint32_t slotCell(const TopScores *top, uint64_t slot)
+{
+    uint64_t x = (slot + 1) * 0x9e3779b97f4a7c15ULL;
+    return (uint32_t)(x >> 32) & top->lookupMask;
+}
+
+// Function to start an empty list that keeps the given number of players
+bool initTopScores(TopScores *top, int capacity)
+{
+    memset(top, 0, sizeof(*top));
+    int size = capacity > 0 ? capacity : 1;
+    uint32_t cells = 2;
+    while (cells < (uint32_t)size * 2)
+    {
+        cells *= 2;
+    }
+    top->heap = (TopEntry *)malloc(sizeof(TopEntry) * size);
+    top->heapCells = (uint32_t *)malloc(sizeof(uint32_t) * size);
+    top->view = (TopEntry *)malloc(sizeof(TopEntry) * size);
+    top->lookup = (uint32_t *)calloc(cells, sizeof(uint32_t));
+    if (top->heap == NULL || top->heapCells == NULL || top->view == NULL || top->lookup == NULL)
+    {
+        freeTopScores(top);
+        return false;
+    }
+    top->capacity = capacity > 0 ? capacity : 0;
+    top->lookupMask = cells - 1;
+    return true;
+}
+
+// Function to free the heap, lookup and view
+void freeTopScores(TopScores *top)
+{
+    free(top->heap);
+    free(top->heapCells);
+    free(top->view);
+    free(top->lookup);
+    memset(top, 0, sizeof(*top));
+}
+
+// Function to put an entry at a heap position, keeping its lookup cell pointing at it
+static void placeEntry(TopScores *top, int position, const TopEntry *entry, uint32_t cell)
+{
+    top->heap[position] = *entry;
+    top->heapCells[position] = cell;
+    top->lookup[cell] = (uint32_t)position + 1;
+}
+
+// Function to move the entry at a position up while it ranks below its parent
+static void siftUp(TopScores *top, int position)
+{
+    TopEntry entry = top->heap[position];
+    uint32_t cell = top->heapCells[position];
+    while (position > 0)
+    {
+        int parent = (position - 1) / 2;
+        if (!ranksBelow(&entry, &top->heap[parent]))
+        {
+            break;
+        }
+        placeEntry(top, position, &top->heap[parent], top->heapCells[parent]);
+        position = parent;
+    }
+    placeEntry(top, position, &entry, cell);
+}
+
+// Function to move the entry at a position down while a child ranks below it
+static void siftDown(TopScores *top, int position)
+{
+    TopEntry entry = top->heap[position];
+    uint32_t cell = top->heapCells[position];
+    while (true)
+    {
+        int child = position * 2 + 1;
+        if (child >= top->count)
+        {
+            break;
+        }
+        if (child + 1 < top->count && ranksBelow(&top->heap[child + 1], &top->heap[child]))
+        {
+            child++;
+        }
+        if (!ranksBelow(&top->heap[child], &entry))
+        {
+            break;
+        }
+        placeEntry(top, position, &top->heap[child], top->heapCells[child]);
+        position = child;
+    }
+    placeEntry(top, position, &entry, cell);
+}
+
+// Function to find a slot's lookup cell; returns the empty cell where it would go if it is not there
+static uint32_t findCell(const TopScores *top, uint64_t slot)
+{
+    uint32_t cell = slotCell(top, slot);
+    while (top->lookup[cell] != 0 && top->heap[top->lookup[cell] - 1].slot != slot)
+    {
+        cell = (cell + 1) & top->lookupMask;
+    }
+    return cell;
+}
+
+// Function to empty a lookup cell, shifting back later cells of its probe run so every slot stays findable
+static void clearCell(TopScores *top, uint32_t cell)
+{
+    uint32_t next = cell;
+    while (true)
+    {
+        next = (next + 1) & top->lookupMask;
+        if (top->lookup[next] == 0)
+        {
+            break;
+        }
+
+        // An entry can move back only if its home cell is not between the hole and where it is now
+        int position = (int)top->lookup[next] - 1;
+        uint32_t home = slotCell(top, top->heap[position].slot);
+        if (((next - home) & top->lookupMask) >= ((next - cell) & top->lookupMask))
+        {
+            top->lookup[cell] = top->lookup[next];
+            top->heapCells[position] = cell;
+            cell = next;
+        }
+    }
+    top->lookup[cell] = 0;
+}
+
+// Function to find where an entry goes in the first viewCount entries of the
+// view: the position of the first one that ranks below it
+static int viewPosition(const TopScores *top, const TopEntry *entry, int viewCount)
+{
+    int low = 0;
+    int high = viewCount;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (ranksBelow(&top->view[middle], entry))
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+// Function to take an entry out of the first viewCount entries of the view
+static void removeFromView(TopScores *top, const TopEntry *entry, int viewCount)
+{
+    // Keys and slots order every entry, so the entry itself is just before where it would go
+    int position = viewPosition(top, entry, viewCount) - 1;
+    memmove(&top->view[position], &top->view[position + 1], sizeof(TopEntry) * (viewCount - position - 1));
+}
+
+// Function to add an entry to the first viewCount entries of the view
+static void insertIntoView(TopScores *top, const TopEntry *entry, int viewCount)
+{
+    int position = viewPosition(top, entry, viewCount);
+    memmove(&top->view[position + 1], &top->view[position], sizeof(TopEntry) * (viewCount - position));
+    top->view[position] = *entry;
+}
+
+// Function to place a player with their current key; a player already in the
+// list moves, a new one replaces the worst if they beat it. Returns whether
+// the player is in the list afterwards
+bool offerTopScore(TopScores *top, uint64_t slot, uint64_t key)
+{
+    if (top->capacity == 0)
+    {
+        return false;
+    }
+    TopEntry entry = {slot, key};
+    uint32_t cell = findCell(top, slot);
+    if (top->lookup[cell] != 0)
+    {
+        // Already in the list: the key changed in place, so the entry moves whichever way it now belongs
+        int position = (int)top->lookup[cell] - 1;
+        bool better = ranksBelow(&top->heap[position], &entry);
+        removeFromView(top, &top->heap[position], top->count);
+        insertIntoView(top, &entry, top->count - 1);
+        top->heap[position].key = key;
+        if (better)
+        {
+            siftDown(top, position);
+        }
+        else
+        {
+            siftUp(top, position);
+        }
+    }
+    else if (top->count < top->capacity)
+    {
+        insertIntoView(top, &entry, top->count);
+        placeEntry(top, top->count++, &entry, cell);
+        siftUp(top, top->count - 1);
+    }
+    else if (ranksBelow(&top->heap[0], &entry))
+    {
+        // Evict the worst, which is last in the view; clearing its cell can
+        // shift the cell found for the new slot, so look it up again
+        insertIntoView(top, &entry, top->count - 1);
+        clearCell(top, top->heapCells[0]);
+        cell = findCell(top, slot);
+        placeEntry(top, 0, &entry, cell);
+        siftDown(top, 0);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+// Function to get the list best first; the view is always in order, so this costs nothing
+const TopEntry *topScoresView(const TopScores *top)
+{
+    return top->view;
+}
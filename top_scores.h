@@ -0,0 +1,38 @@
+// Top-K list for the leaderboard
+// A min-heap of the K best players, so a new run is checked against the
+// K-th best in O(1) and absorbed in O(log K), with a slot lookup so a
+// player already in it moves instead of appearing twice. The best-first
+// view is kept in order alongside, so reading the list never sorts it
+
+#ifndef TOP_SCORES_H
+#define TOP_SCORES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Structure to store one player of the top-K list
+typedef struct
+{
+    uint64_t slot;
+    uint64_t key;
+} TopEntry;
+
+// Structure to store the heap, its slot lookup and the ordered view
+typedef struct
+{
+    TopEntry *heap;
+    uint32_t *heapCells;
+    int count;
+    int capacity;
+    uint32_t *lookup;
+    uint32_t lookupMask;
+    TopEntry *view;
+} TopScores;
+
+// Function prototypes
+bool initTopScores(TopScores *top, int capacity);
+void freeTopScores(TopScores *top);
+bool offerTopScore(TopScores *top, uint64_t slot, uint64_t key);
+const TopEntry *topScoresView(const TopScores *top);
+
+#endif